@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace choros {
+
+/**
+ * @brief Non-owning, read-only view of a contiguous array.
+ *
+ * Used for the frozen navigation layout, whose arrays live either in an
+ * in-memory image or in a memory-mapped map file. The viewed memory must
+ * outlive the view.
+ */
+template <typename T> class ArrayView {
+  public:
+    ArrayView() = default;
+    ArrayView(const T *data, std::size_t size) : first(data), count(size) {}
+
+    const T &operator[](std::size_t index) const { return first[index]; }
+    const T *data() const { return first; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T *begin() const { return first; }
+    const T *end() const { return first + count; }
+
+  private:
+    const T *first = nullptr;
+    std::size_t count = 0;
+};
+
+} // namespace choros
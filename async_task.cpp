@@ -0,0 +1,56 @@
+#include "async_task.hpp"
+#include <thread>
+
+namespace choros {
+
+TaskCoroutine &TaskCoroutine::operator=(TaskCoroutine &&other) noexcept {
+    if (this != &other) {
+        if (handle)
+            handle.destroy();
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+TaskCoroutine::~TaskCoroutine() {
+    if (handle)
+        handle.destroy();
+}
+
+bool TaskCoroutine::ready(Clock::time_point now) {
+    promise_type &promise = handle.promise();
+    if (now < promise.wake_at)
+        return false;
+    if (promise.condition && !promise.condition()) {
+        promise.wake_at = now + promise.poll;
+        return false;
+    }
+    return true;
+}
+
+void TaskCoroutine::resume() {
+    handle.promise().condition = nullptr;
+    handle.resume();
+}
+
+TaskResult TaskCoroutine::result() const {
+    const promise_type &promise = handle.promise();
+    if (promise.error)
+        std::rethrow_exception(promise.error);
+    return promise.result;
+}
+
+TaskResult AsyncTask::execute(Lifecycle &lifecycle) {
+    TaskCoroutine routine = run(lifecycle);
+    while (true) {
+        if (!routine.ready(TaskCoroutine::Clock::now())) {
+            std::this_thread::sleep_until(routine.wake_at());
+            continue;
+        }
+        routine.resume();
+        if (routine.done())
+            return routine.result();
+    }
+}
+
+} // namespace choros
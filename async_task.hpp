@@ -0,0 +1,188 @@
+#pragma once
+
+#include "task.hpp"
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+
+namespace choros {
+
+/**
+ * @brief Coroutine returned by `AsyncTask::run()`.
+ *
+ * Owns the coroutine frame. The coroutine starts suspended and finishes with
+ * `co_return` of a `TaskResult`; in between it may suspend on the awaitables
+ * below (`sleep_for()`, `sleep_until()` and `wait_until()`), which record in
+ * the promise when it wants to be resumed. The driver (the lifecycle's event
+ * loop or `AsyncTask::execute()`) polls `ready()` and calls `resume()`.
+ */
+class TaskCoroutine {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct promise_type {
+        TaskResult result = TaskResult::FATAL_FAILURE;
+        std::exception_ptr error;
+        /// Earliest time at which the coroutine should be looked at again
+        Clock::time_point wake_at = Clock::time_point::min();
+        /// Condition the coroutine waits for; empty for a plain sleep
+        std::function<bool()> condition;
+        /// How often `condition` is polled
+        Clock::duration poll{0};
+
+        TaskCoroutine get_return_object() {
+            return TaskCoroutine(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(TaskResult value) { result = value; }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    TaskCoroutine(TaskCoroutine &&other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) {}
+    TaskCoroutine &operator=(TaskCoroutine &&other) noexcept;
+    TaskCoroutine(const TaskCoroutine &) = delete;
+    TaskCoroutine &operator=(const TaskCoroutine &) = delete;
+    ~TaskCoroutine();
+
+    /// Returns true once the coroutine has finished.
+    bool done() const { return handle.done(); }
+
+    /**
+     * @brief Returns true if the coroutine should be resumed at `now`.
+     *
+     * Polls the awaited condition, if any; when it does not hold yet the
+     * next poll is scheduled one poll interval later.
+     */
+    bool ready(Clock::time_point now);
+
+    /// Runs the coroutine until it suspends again or finishes.
+    void resume();
+
+    /// Earliest time at which `ready()` may return true.
+    Clock::time_point wake_at() const { return handle.promise().wake_at; }
+
+    /**
+     * @brief Returns the result of a finished coroutine, rethrowing any
+     * exception that escaped it.
+     */
+    TaskResult result() const;
+
+  private:
+    explicit TaskCoroutine(Handle handle) : handle(handle) {}
+
+    Handle handle;
+};
+
+/**
+ * @brief A task whose body is a coroutine.
+ *
+ * Instead of blocking in `execute()`, an `AsyncTask` implements `run()` and
+ * suspends while waiting on hardware:
+ *
+ * @code
+ * TaskCoroutine run(Lifecycle &lifecycle) override {
+ *     set_servo_position(0, 1800);
+ *     co_await sleep_for(std::chrono::milliseconds(400));
+ *     co_await wait_until([] { return analog(2) > 3000; });
+ *     co_return TaskResult::SUCCESS;
+ * }
+ * @endcode
+ *
+ * With the default parallelism of 1, the lifecycle drives all running async
+ * tasks from a single-threaded event loop on the calling thread, so they
+ * interleave without data races on the hardware API. A suspended task keeps
+ * its `TaskOptions::resource` until it finishes. With parallelism above 1,
+ * or when `execute()` is called directly, the coroutine is run to completion
+ * on the calling thread, sleeping while it is suspended.
+ */
+class AsyncTask : public Task {
+  public:
+    /**
+     * @brief Starts one attempt at this task.
+     *
+     * The coroutine is created suspended; the first `resume()` runs it up to
+     * its first `co_await`.
+     */
+    virtual TaskCoroutine run(Lifecycle &lifecycle) = 0;
+
+    /**
+     * @brief Runs `run()` to completion, sleeping while it is suspended.
+     */
+    TaskResult execute(Lifecycle &lifecycle) final;
+};
+
+/**
+ * @brief Awaitable that resumes the coroutine at a point in time.
+ *
+ * Always suspends, even if `when` has passed, so awaiting it yields to the
+ * other tasks of the event loop.
+ */
+struct SleepAwaiter {
+    TaskCoroutine::Clock::time_point when;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(TaskCoroutine::Handle handle) const noexcept {
+        handle.promise().wake_at = when;
+    }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Awaitable that resumes the coroutine once a predicate holds.
+ *
+ * Does not suspend if the predicate already holds.
+ */
+struct ConditionAwaiter {
+    std::function<bool()> condition;
+    TaskCoroutine::Clock::duration poll;
+
+    bool await_ready() const { return condition(); }
+    void await_suspend(TaskCoroutine::Handle handle) {
+        auto &promise = handle.promise();
+        promise.condition = std::move(condition);
+        promise.poll = poll;
+        promise.wake_at = TaskCoroutine::Clock::now() + poll;
+    }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Suspends the awaiting task for `duration`; `sleep_for(0ms)` just
+ * yields.
+ */
+template <typename Rep, typename Period>
+SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+    return {TaskCoroutine::Clock::now() +
+            std::chrono::duration_cast<TaskCoroutine::Clock::duration>(
+                duration)};
+}
+
+/**
+ * @brief Suspends the awaiting task until `when`.
+ */
+inline SleepAwaiter sleep_until(TaskCoroutine::Clock::time_point when) {
+    return {when};
+}
+
+/**
+ * @brief Suspends the awaiting task until `condition` returns true.
+ *
+ * The predicate runs on the event loop's thread, once every `poll`.
+ *
+ * @param condition Predicate, e.g. a sensor threshold
+ * @param poll Interval between two evaluations of `condition`
+ */
+inline ConditionAwaiter
+wait_until(std::function<bool()> condition,
+           std::chrono::milliseconds poll = std::chrono::milliseconds(1)) {
+    return {std::move(condition), poll};
+}
+
+} // namespace choros
@@ -0,0 +1,93 @@
+#include "allocation_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+void *allocate(std::size_t size) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *allocate(std::size_t size, std::align_val_t align) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc() wants a size that is a multiple of the alignment
+    const auto alignment = static_cast<std::size_t>(align);
+    const std::size_t rounded =
+        ((size ? size : 1) + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded);
+}
+
+template <typename... Align> void *allocate_or_throw(Align... args) {
+    if (void *p = allocate(args...))
+        return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+namespace choros::bench {
+
+std::uint64_t allocation_count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+} // namespace choros::bench
+
+// Every replaceable form, so that array and over-aligned allocations are
+// counted as well; all of them release through free()
+
+void *operator new(std::size_t size) { return allocate_or_throw(size); }
+void *operator new[](std::size_t size) { return allocate_or_throw(size); }
+void *operator new(std::size_t size, std::align_val_t align) {
+    return allocate_or_throw(size, align);
+}
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return allocate_or_throw(size, align);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+void *operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept {
+    return allocate(size, align);
+}
+void *operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t &) noexcept {
+    return allocate(size, align);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+    std::free(p);
+}
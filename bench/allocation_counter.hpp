@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace choros::bench {
+
+/**
+ * @brief Returns the number of heap allocations made through any form of
+ * global `operator new` since the program started.
+ *
+ * The replacement operators live in their own translation unit, so the
+ * optimizer never sees a replaced `new` inlined next to its `delete`.
+ */
+std::uint64_t allocation_count();
+
+} // namespace choros::bench
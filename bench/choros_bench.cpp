@@ -0,0 +1,495 @@
+/**
+ * @brief Micro-benchmarks for the Navigation and Lifecycle hot paths.
+ *
+ * Usage: choros_bench [filter] [iterations]
+ *
+ * Runs every benchmark whose name contains `filter` (all by default) and
+ * reports per-call latency percentiles and heap allocations per call.
+ * Graphs are synthetic fields: a grid of PRIMARY intersections with a
+ * SECONDARY terminal hanging off every third one.
+ */
+#include "allocation_counter.hpp"
+#include "incremental_planner.hpp"
+#include "lifecycle.hpp"
+#include "metrics.hpp"
+#include "navigation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace choros;
+using Clock = std::chrono::steady_clock;
+
+constexpr float SPACING = 10.0f;
+
+struct Options {
+    std::string filter;
+    std::size_t iterations = 2000;
+};
+
+/// A generated field plus the names queries are drawn from
+struct Field {
+    std::vector<std::string> nodes;
+    std::size_t width = 0;
+    std::size_t height = 0;
+};
+
+std::string grid_name(std::size_t x, std::size_t y) {
+    return "p" + std::to_string(x) + "_" + std::to_string(y);
+}
+
+std::string task_name(std::size_t i) {
+    // Appending avoids a bogus -Wrestrict in GCC 12 for "t" + to_string(i)
+    std::string name = "t";
+    name += std::to_string(i);
+    return name;
+}
+
+/**
+ * @brief Describes a grid field with roughly `target_nodes` nodes.
+ *
+ * Edge weights are at least the coordinate distance between their
+ * endpoints, so the A* heuristics stay admissible.
+ */
+Field field_specs(std::size_t target_nodes, std::vector<NodeSpec> &nodes,
+                  std::vector<EdgeSpec> &edges, unsigned seed = 42) {
+    Field field;
+    // Every third primary carries one secondary terminal
+    const std::size_t primaries =
+        std::max<std::size_t>(4, target_nodes * 3 / 4);
+    field.width = static_cast<std::size_t>(std::ceil(std::sqrt(primaries)));
+    field.height = (primaries + field.width - 1) / field.width;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> extra(0.0f, SPACING / 2);
+
+    for (std::size_t y = 0; y < field.height; ++y) {
+        for (std::size_t x = 0; x < field.width; ++x) {
+            std::string name = grid_name(x, y);
+            nodes.push_back({name, NodeType::PRIMARY,
+                             Position{x * SPACING, y * SPACING}});
+            field.nodes.push_back(name);
+        }
+    }
+    for (std::size_t y = 0; y < field.height; ++y) {
+        for (std::size_t x = 0; x < field.width; ++x) {
+            if (x + 1 < field.width)
+                edges.push_back({grid_name(x, y), grid_name(x + 1, y),
+                                 SPACING + extra(rng), Direction::EAST});
+            if (y + 1 < field.height)
+                edges.push_back({grid_name(x, y), grid_name(x, y + 1),
+                                 SPACING + extra(rng), Direction::NORTH});
+        }
+    }
+    for (std::size_t i = 0; i < field.width * field.height; i += 3) {
+        const std::size_t x = i % field.width, y = i / field.width;
+        std::string name = "s" + std::to_string(i);
+        nodes.push_back({name, NodeType::SECONDARY,
+                         Position{x * SPACING + SPACING / 3, y * SPACING}});
+        edges.push_back({name, grid_name(x, y), SPACING / 3, Direction::WEST});
+        field.nodes.push_back(name);
+    }
+    return field;
+}
+
+/**
+ * @brief Adds the nodes and edges of `field_specs()` one at a time.
+ */
+void add_specs(Navigation &nav, const std::vector<NodeSpec> &nodes,
+               const std::vector<EdgeSpec> &edges) {
+    for (const NodeSpec &node : nodes)
+        nav.add_node(node.name, node.type, *node.position);
+    for (const EdgeSpec &edge : edges)
+        nav.add_edge(edge.from, edge.to, edge.weight, edge.direction);
+}
+
+/**
+ * @brief Builds a grid field with roughly `target_nodes` nodes through the
+ * incremental API.
+ */
+Field build_field(Navigation &nav, std::size_t target_nodes,
+                  unsigned seed = 42) {
+    std::vector<NodeSpec> nodes;
+    std::vector<EdgeSpec> edges;
+    Field field = field_specs(target_nodes, nodes, edges, seed);
+    add_specs(nav, nodes, edges);
+    return field;
+}
+
+/// A pre-drawn query: start, target and a blacklist of primaries
+struct Query {
+    std::string from;
+    std::string to;
+    std::unordered_set<std::string> blacklist;
+};
+
+std::vector<Query> make_queries(const Field &field, std::size_t count,
+                                std::size_t blacklist_size,
+                                unsigned seed = 7) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> pick(0, field.nodes.size() - 1);
+    std::uniform_int_distribution<std::size_t> pick_primary(
+        0, field.width * field.height - 1);
+    std::vector<Query> queries(count);
+    for (auto &query : queries) {
+        query.from = field.nodes[pick(rng)];
+        query.to = field.nodes[pick(rng)];
+        while (query.blacklist.size() < blacklist_size) {
+            const std::string &node = field.nodes[pick_primary(rng)];
+            if (node != query.from && node != query.to)
+                query.blacklist.insert(node);
+        }
+    }
+    return queries;
+}
+
+/**
+ * @brief Times `body(i)` for `iterations` calls and prints one report line.
+ */
+void measure(const Options &options, const std::string &name,
+             std::size_t nodes, std::size_t iterations,
+             const std::function<void(std::size_t)> &body) {
+    if (name.find(options.filter) == std::string::npos)
+        return;
+
+    // Warm up caches, workspaces and lazily built state
+    for (std::size_t i = 0; i < std::min<std::size_t>(iterations, 16); ++i)
+        body(i);
+
+    std::vector<double> micros(iterations);
+    const std::uint64_t allocations_before = bench::allocation_count();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        const auto start = Clock::now();
+        body(i);
+        micros[i] =
+            std::chrono::duration<double, std::micro>(Clock::now() - start)
+                .count();
+    }
+    const std::uint64_t allocations =
+        bench::allocation_count() - allocations_before;
+
+    std::sort(micros.begin(), micros.end());
+    auto percentile = [&](double p) {
+        return micros[static_cast<std::size_t>(p * (micros.size() - 1))];
+    };
+    std::printf("%-34s %7zu %7zu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                name.c_str(), nodes, iterations, percentile(0.5),
+                percentile(0.9), percentile(0.99), micros.back(),
+                static_cast<double>(allocations) / iterations);
+}
+
+void bench_construction(const Options &options) {
+    for (std::size_t size : {50, 500, 2000, 10000}) {
+        std::vector<NodeSpec> nodes;
+        std::vector<EdgeSpec> edges;
+        field_specs(size, nodes, edges);
+        const std::size_t iterations =
+            std::max<std::size_t>(10, options.iterations * 5 / nodes.size());
+        const std::string suffix = "/" + std::to_string(nodes.size());
+
+        measure(options, "construct/add_edge" + suffix, nodes.size(),
+                iterations, [&](std::size_t) {
+                    Navigation nav;
+                    add_specs(nav, nodes, edges);
+                    nav.freeze();
+                });
+        measure(options, "construct/build" + suffix, nodes.size(), iterations,
+                [&](std::size_t) { Navigation::build(nodes, edges); });
+        Navigation built = Navigation::build(nodes, edges);
+        measure(options, "construct/hierarchy" + suffix, nodes.size(),
+                std::max<std::size_t>(1, iterations / 10), [&](std::size_t) {
+                    Navigation copy = built;
+                    copy.build_contraction_hierarchy();
+                });
+
+        const std::string map = "choros_bench.map";
+        Navigation::build(nodes, edges).save(map);
+        measure(options, "construct/load" + suffix, nodes.size(), iterations,
+                [&](std::size_t) { Navigation::load(map); });
+        std::remove(map.c_str());
+    }
+}
+
+void bench_navigation(const Options &options) {
+    for (std::size_t size : {50, 500, 2000, 10000}) {
+        Navigation dynamic;
+        Field field = build_field(dynamic, size);
+        Navigation frozen;
+        build_field(frozen, size);
+        frozen.freeze();
+        const std::size_t nodes = frozen.node_count();
+        const std::size_t iterations =
+            std::max<std::size_t>(50, options.iterations * 500 / nodes);
+
+        std::vector<Query> clear = make_queries(field, iterations, 0);
+        std::vector<Query> blocked = make_queries(field, iterations, 8);
+        const std::string suffix = "/" + std::to_string(nodes);
+
+        measure(options, "find_path/dynamic" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    dynamic.set_node(blocked[i].from);
+                    dynamic.find_path(blocked[i].to, blocked[i].blacklist);
+                });
+        measure(options, "find_path/frozen" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path(blocked[i].to, blocked[i].blacklist);
+                });
+
+        PathWorkspace workspace(nodes);
+        std::vector<Edge> path;
+        MetricsRegistry metrics;
+        MetricsRegistry::install(&metrics);
+        measure(options, "find_path/metrics" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path(blocked[i].to, blocked[i].blacklist,
+                                     workspace, path);
+                });
+        MetricsRegistry::install(nullptr);
+
+        measure(options, "find_path/workspace" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path(blocked[i].to, blocked[i].blacklist,
+                                     workspace, path);
+                });
+
+        std::vector<NodeMask> masks(iterations, frozen.node_mask());
+        for (std::size_t i = 0; i < iterations; ++i) {
+            for (const auto &node : blocked[i].blacklist)
+                masks[i].set(frozen.node_id(node).value());
+        }
+        measure(options, "find_path/mask" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path(blocked[i].to, masks[i], workspace, path);
+                });
+
+        Navigation bidirectional = frozen;
+        bidirectional.set_search_strategy(SearchStrategy::BIDIRECTIONAL);
+        measure(options, "find_path/bidirectional" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    bidirectional.set_node(blocked[i].from);
+                    bidirectional.find_path(blocked[i].to, masks[i], workspace,
+                                            path);
+                });
+
+        EdgePath edge_path;
+        measure(options, "find_edge_path/mask" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_edge_path(blocked[i].to, masks[i], edge_path);
+                });
+
+        // Empty blacklists, as answered by a contraction hierarchy
+        Navigation contracted = frozen;
+        contracted.build_contraction_hierarchy();
+        measure(options, "find_edge_path/dijkstra" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(clear[i].from);
+                    frozen.find_edge_path(clear[i].to, edge_path);
+                });
+        measure(options, "find_edge_path/hierarchy" + suffix, nodes,
+                iterations, [&](std::size_t i) {
+                    contracted.set_node(clear[i].from);
+                    contracted.find_edge_path(clear[i].to, edge_path);
+                });
+
+        // Sixteen stateless queries per call, spread over every core
+        ThreadPool pool;
+        std::vector<PathQuery> batch(16);
+        std::vector<PathResult> results;
+        measure(options,
+                "find_path_batch/" + std::to_string(pool.size()) + suffix,
+                nodes, iterations, [&](std::size_t i) {
+                    for (std::size_t k = 0; k < batch.size(); ++k) {
+                        const std::size_t q = (i + k) % iterations;
+                        batch[k] = {
+                            frozen.node_id(blocked[q].from).value(),
+                            frozen.node_id(blocked[q].to).value(), &masks[q]};
+                    }
+                    frozen.find_path_batch(batch, results, pool);
+                });
+
+        measure(options, "find_path_astar/manhattan" + suffix, nodes,
+                iterations, [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path_astar(blocked[i].to,
+                                           blocked[i].blacklist, workspace,
+                                           path, ManhattanHeuristic{});
+                });
+
+        // Goal selection among five candidate zones
+        std::vector<std::vector<std::string>> zones(iterations);
+        for (std::size_t i = 0; i < iterations; ++i) {
+            for (std::size_t k = 0; k < 5; ++k)
+                zones[i].push_back(blocked[(i + k + 1) % iterations].to);
+        }
+        measure(options, "find_path/x5" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    for (const std::string &zone : zones[i])
+                        frozen.find_path(zone, blocked[i].blacklist, workspace,
+                                         path);
+                });
+        measure(options, "find_paths/5" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_paths(zones[i], blocked[i].blacklist);
+                });
+        measure(options, "find_nearest/5" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_nearest(zones[i], blocked[i].blacklist);
+                });
+
+        const TurnCosts turns{SPACING / 2, SPACING, SPACING / 4};
+        measure(options, "find_path_turns" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    frozen.set_node(blocked[i].from);
+                    frozen.find_path_turns(blocked[i].to, turns,
+                                           blocked[i].blacklist, workspace,
+                                           path, Direction::EAST);
+                });
+
+        if (nodes <= 2000) {
+            Navigation cached;
+            build_field(cached, size);
+            cached.freeze();
+            cached.build_path_cache();
+            measure(options, "find_path/cache" + suffix, nodes, iterations,
+                    [&](std::size_t i) {
+                        cached.set_node(clear[i].from);
+                        cached.find_path(clear[i].to, {}, workspace, path);
+                    });
+        }
+
+        // The blacklist toggles one node per query, as when robots move
+        IncrementalPlanner planner(frozen, field.nodes.back());
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<std::size_t> pick(
+            0, field.width * field.height - 1);
+        measure(options, "incremental/toggle_one" + suffix, nodes, iterations,
+                [&](std::size_t i) {
+                    const std::string &node = field.nodes[pick(rng)];
+                    if (planner.is_blocked(node))
+                        planner.unblock(node);
+                    else
+                        planner.block(node);
+                    planner.find_path(field.nodes[i % 7]);
+                });
+    }
+}
+
+/// Exposes the task executor of `Lifecycle` with no-op phases
+class BenchLifecycle : public Lifecycle {
+  public:
+    using Lifecycle::execute_tasks;
+
+  protected:
+    void declare() override {}
+    void calibrate() override {}
+    void wait() override {}
+    void clean() override {}
+    void reset() override {}
+};
+
+class NoopTask : public Task {
+  public:
+    TaskResult execute(Lifecycle &) override { return TaskResult::SUCCESS; }
+};
+
+enum class DagShape { WIDE, DEEP };
+
+void build_dag(BenchLifecycle &lifecycle, DagShape shape, std::size_t size,
+               const std::shared_ptr<Task> &task) {
+    std::vector<TaskHandle> handles;
+    handles.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+        handles.push_back(lifecycle.add_task(task_name(i), task));
+    for (std::size_t i = 1; i < size; ++i) {
+        if (shape == DagShape::DEEP)
+            lifecycle.add_dependency(handles[i - 1], handles[i]);
+        else if (i + 1 < size)
+            lifecycle.add_dependency(handles[0], handles[i]); // fan out
+        else
+            for (std::size_t j = 1; j + 1 < size; ++j)
+                lifecycle.add_dependency(handles[j], handles[i]); // fan in
+    }
+}
+
+void bench_lifecycle(const Options &options) {
+    auto task = std::make_shared<NoopTask>();
+    for (DagShape shape : {DagShape::WIDE, DagShape::DEEP}) {
+        for (std::size_t size : {10, 100, 1000}) {
+            const std::size_t iterations =
+                std::max<std::size_t>(20, options.iterations * 10 / size);
+            const std::string name =
+                std::string("execute_tasks/") +
+                (shape == DagShape::WIDE ? "wide" : "deep") + "/" +
+                std::to_string(size);
+            if (name.find(options.filter) == std::string::npos)
+                continue;
+
+            // Each run needs a fresh graph; build them outside the timing
+            std::vector<BenchLifecycle> runs(iterations + 16);
+            for (auto &lifecycle : runs)
+                build_dag(lifecycle, shape, size, task);
+            std::size_t next = 0;
+            measure(options, name, size, iterations,
+                    [&](std::size_t) { runs[next++].execute_tasks(); });
+        }
+    }
+
+    // Data-driven runs: one small task object per task, built and executed
+    const std::size_t size = 500;
+    const std::size_t iterations =
+        std::max<std::size_t>(20, options.iterations * 10 / size);
+    std::vector<std::string> ids;
+    for (std::size_t i = 0; i < size; ++i)
+        ids.push_back(task_name(i));
+    for (bool arena : {false, true}) {
+        const std::string name = std::string("micro_tasks/") +
+                                 (arena ? "arena" : "shared") + "/" +
+                                 std::to_string(size);
+        if (name.find(options.filter) == std::string::npos)
+            continue;
+        measure(options, name, size, iterations, [&](std::size_t) {
+            BenchLifecycle lifecycle;
+            for (const std::string &id : ids) {
+                if (arena)
+                    lifecycle.emplace_task<NoopTask>(id, {});
+                else
+                    lifecycle.add_task(id, std::make_shared<NoopTask>());
+            }
+            lifecycle.execute_tasks();
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (argc > 1)
+        options.filter = argv[1];
+    if (argc > 2)
+        options.iterations = std::strtoul(argv[2], nullptr, 10);
+
+    std::printf("%-34s %7s %7s %9s %9s %9s %9s %9s\n", "benchmark", "nodes",
+                "calls", "p50(us)", "p90(us)", "p99(us)", "max(us)",
+                "allocs");
+    bench_construction(options);
+    bench_navigation(options);
+    bench_lifecycle(options);
+    return 0;
+}
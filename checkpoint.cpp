@@ -0,0 +1,281 @@
+#include "checkpoint.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace choros {
+
+namespace {
+
+constexpr char CHECKPOINT_MAGIC[8] = {'C', 'H', 'O', 'R', 'O', 'S', 'C', 'P'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+
+/// File header, followed by records of the form
+/// `[type:u8][size:u16][payload:size][checksum:u32]`
+struct CheckpointHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+constexpr std::size_t RECORD_OVERHEAD = 1 + 2 + 4;
+
+/// FNV-1a, folded to 32 bits
+std::uint32_t checksum(const unsigned char *data, std::size_t size) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001b3ull;
+    }
+    return static_cast<std::uint32_t>(h ^ (h >> 32));
+}
+
+template <typename T> T read_value(const unsigned char *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+void write_all(int fd, const unsigned char *data, std::size_t size,
+               const std::string &path) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(),
+                                    "Cannot write checkpoint " + path);
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+} // namespace
+
+CheckpointLog::CheckpointLog(const std::string &path,
+                             std::chrono::milliseconds sync_interval)
+    : path(path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot open checkpoint " + path);
+
+    struct stat info;
+    std::vector<unsigned char> bytes;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        bytes.resize(static_cast<std::size_t>(info.st_size));
+        std::size_t read = 0;
+        while (read < bytes.size()) {
+            const ssize_t got =
+                ::pread(fd, bytes.data() + read, bytes.size() - read,
+                        static_cast<off_t>(read));
+            if (got <= 0) {
+                if (got < 0 && errno == EINTR)
+                    continue;
+                break;
+            }
+            read += static_cast<std::size_t>(got);
+        }
+        bytes.resize(read);
+    }
+
+    std::size_t valid = 0;
+    if (bytes.empty()) {
+        CheckpointHeader header{};
+        std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header.version = CHECKPOINT_VERSION;
+        write_all(fd, reinterpret_cast<const unsigned char *>(&header),
+                  sizeof(header), path);
+        valid = sizeof(header);
+    } else {
+        CheckpointHeader header{};
+        if (bytes.size() >= sizeof(header))
+            std::memcpy(&header, bytes.data(), sizeof(header));
+        if (bytes.size() < sizeof(header) ||
+            std::memcmp(header.magic, CHECKPOINT_MAGIC,
+                        sizeof(CHECKPOINT_MAGIC)) != 0 ||
+            header.version != CHECKPOINT_VERSION) {
+            ::close(fd);
+            throw std::runtime_error("Invalid checkpoint log " + path);
+        }
+        replay(bytes, valid);
+    }
+
+    // Cut off a torn tail so new records follow the last intact one
+    if (::ftruncate(fd, static_cast<off_t>(valid)) != 0 ||
+        ::lseek(fd, static_cast<off_t>(valid), SEEK_SET) < 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "Cannot open checkpoint " + path);
+    }
+    flusher = std::thread(&CheckpointLog::run, this, sync_interval);
+}
+
+CheckpointLog::~CheckpointLog() {
+    {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        stop = true;
+    }
+    wake.notify_one();
+    flusher.join();
+    try {
+        flush();
+    } catch (const std::exception &) {
+        // Nothing to report to; a resume replays what reached the disk
+    }
+    ::close(fd);
+}
+
+void CheckpointLog::replay(const std::vector<unsigned char> &bytes,
+                           std::size_t &valid) {
+    std::size_t at = sizeof(CheckpointHeader);
+    valid = at;
+    while (at + RECORD_OVERHEAD <= bytes.size()) {
+        const unsigned char *record = bytes.data() + at;
+        const auto size = read_value<std::uint16_t>(record + 1);
+        if (at + RECORD_OVERHEAD + size > bytes.size())
+            break;
+        if (read_value<std::uint32_t>(record + 3 + size) !=
+            checksum(record, 3 + size))
+            break;
+
+        const unsigned char *payload = record + 3;
+        switch (record[0]) {
+        case GRAPH:
+            replayed.graph = read_value<std::uint64_t>(payload);
+            replayed.tasks.clear();
+            replayed.attempts.clear();
+            break;
+        case PHASE:
+            replayed.phases |= std::uint32_t{1} << payload[0];
+            break;
+        case TASK:
+        case ATTEMPT: {
+            const auto task = read_value<TaskHandle>(payload);
+            if (replayed.tasks.size() <= task) {
+                replayed.tasks.resize(task + 1, TaskState::PENDING);
+                replayed.attempts.resize(task + 1, 0);
+            }
+            if (record[0] == TASK)
+                replayed.tasks[task] = static_cast<TaskState>(payload[4]);
+            else
+                replayed.attempts[task] =
+                    read_value<std::uint32_t>(payload + 4);
+            break;
+        }
+        case NODE:
+            replayed.node.emplace(reinterpret_cast<const char *>(payload),
+                                  size);
+            break;
+        default:
+            break;
+        }
+        at += RECORD_OVERHEAD + size;
+        valid = at;
+    }
+}
+
+void CheckpointLog::record_graph(std::uint64_t fingerprint) {
+    append(GRAPH, &fingerprint, sizeof(fingerprint));
+}
+
+void CheckpointLog::record_phase(LifecyclePhase phase) {
+    const auto value = static_cast<std::uint8_t>(phase);
+    append(PHASE, &value, sizeof(value));
+}
+
+void CheckpointLog::record_task(TaskHandle task, TaskState state) {
+    unsigned char payload[5];
+    std::memcpy(payload, &task, sizeof(task));
+    payload[4] = static_cast<unsigned char>(state);
+    append(TASK, payload, sizeof(payload));
+}
+
+void CheckpointLog::record_attempt(TaskHandle task, std::uint32_t attempts) {
+    unsigned char payload[8];
+    std::memcpy(payload, &task, sizeof(task));
+    std::memcpy(payload + 4, &attempts, sizeof(attempts));
+    append(ATTEMPT, payload, sizeof(payload));
+}
+
+void CheckpointLog::record_node(const std::string &node) {
+    const std::size_t size = std::min<std::size_t>(
+        node.size(), std::numeric_limits<std::uint16_t>::max());
+    append(NODE, node.data(), static_cast<std::uint16_t>(size));
+}
+
+void CheckpointLog::append(RecordType type, const void *payload,
+                           std::uint16_t size) {
+    std::lock_guard<std::mutex> lock(append_mutex);
+    const std::size_t start = pending.size();
+    pending.resize(start + RECORD_OVERHEAD + size);
+    unsigned char *record = pending.data() + start;
+    record[0] = type;
+    std::memcpy(record + 1, &size, sizeof(size));
+    std::memcpy(record + 3, payload, size);
+    const std::uint32_t sum = checksum(record, 3 + size);
+    std::memcpy(record + 3 + size, &sum, sizeof(sum));
+}
+
+void CheckpointLog::flush() {
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+    std::vector<unsigned char> batch;
+    {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        batch.swap(pending);
+    }
+    if (batch.empty())
+        return;
+    write_all(fd, batch.data(), batch.size(), path);
+    if (::fdatasync(fd) != 0)
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot sync checkpoint " + path);
+
+    // Hand the buffer back for reuse unless new records arrived meanwhile
+    batch.clear();
+    std::lock_guard<std::mutex> lock(append_mutex);
+    if (pending.empty())
+        pending.swap(batch);
+}
+
+void CheckpointLog::sync() { flush(); }
+
+void CheckpointLog::clear() {
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+    {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        pending.clear();
+    }
+    replayed = {};
+    if (::ftruncate(fd, sizeof(CheckpointHeader)) != 0 ||
+        ::lseek(fd, sizeof(CheckpointHeader), SEEK_SET) < 0 ||
+        ::fdatasync(fd) != 0)
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot clear checkpoint " + path);
+}
+
+void CheckpointLog::run(std::chrono::milliseconds sync_interval) {
+    std::unique_lock<std::mutex> lock(append_mutex);
+    while (!stop) {
+        wake.wait_for(lock, sync_interval, [&] { return stop; });
+        if (stop || pending.empty())
+            continue;
+        lock.unlock();
+        try {
+            flush();
+        } catch (const std::exception &) {
+            // The batch is lost; a resume redoes the work it recorded
+        }
+        lock.lock();
+    }
+}
+
+} // namespace choros
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "lifecycle.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Lifecycle progress replayed from a checkpoint log.
+ */
+struct CheckpointState {
+    /// Fingerprint of the task graph the task records refer to; 0 if the
+    /// log holds none
+    std::uint64_t graph = 0;
+
+    /// Bit `p` is set once phase `p` has finished
+    std::uint32_t phases = 0;
+
+    /// Settled state (`SUCCEEDED` or `FAILED`) by handle; `PENDING` for
+    /// tasks without a record
+    std::vector<TaskState> tasks;
+
+    /// Attempts started per handle
+    std::vector<std::uint32_t> attempts;
+
+    /// Last node recorded with `Lifecycle::record_node()`
+    std::optional<std::string> node;
+
+    /// Returns true if `phase` has finished.
+    bool finished(LifecyclePhase phase) const {
+        return phases & (std::uint32_t{1} << static_cast<int>(phase));
+    }
+};
+
+/**
+ * @brief Append-only log of lifecycle progress, for resuming after a crash.
+ *
+ * Every change is appended as a small checksummed record. Appending only
+ * copies the record into a buffer; a background thread writes the buffer
+ * and `fdatasync()`s it every `sync_interval`, so a crash loses at most
+ * that much progress and the executor never waits on the disk. A record
+ * torn by a crash fails its checksum and ends the replay; the file is cut
+ * back to the last intact record before anything is appended.
+ *
+ * Used by `Lifecycle::enable_checkpoint()`; not meant to be shared between
+ * processes. Throws `std::system_error` if the file cannot be opened, and
+ * `std::runtime_error` if it is not a checkpoint log.
+ */
+class CheckpointLog {
+  public:
+    /**
+     * @brief Opens or creates a log and replays it into `state()`.
+     *
+     * @param path File to append to
+     * @param sync_interval Time between two syncs of appended records
+     */
+    CheckpointLog(const std::string &path,
+                  std::chrono::milliseconds sync_interval);
+
+    /// Syncs the remaining records and closes the file.
+    ~CheckpointLog();
+
+    CheckpointLog(const CheckpointLog &) = delete;
+    CheckpointLog &operator=(const CheckpointLog &) = delete;
+
+    /// Progress replayed when the log was opened.
+    const CheckpointState &state() const { return replayed; }
+
+    /// Records the task graph that subsequent task records refer to; a
+    /// replay drops the task records before it.
+    void record_graph(std::uint64_t fingerprint);
+
+    /// Records that a phase has finished.
+    void record_phase(LifecyclePhase phase);
+
+    /// Records that a task settled as `SUCCEEDED` or `FAILED`.
+    void record_task(TaskHandle task, TaskState state);
+
+    /// Records that the attempt number `attempts` of a task started.
+    void record_attempt(TaskHandle task, std::uint32_t attempts);
+
+    /// Records the robot's node.
+    void record_node(const std::string &node);
+
+    /// Writes and syncs every record appended so far.
+    void sync();
+
+    /// Discards all records and the replayed state, e.g. once a run
+    /// finished.
+    void clear();
+
+  private:
+    enum RecordType : std::uint8_t { GRAPH = 1, PHASE, TASK, ATTEMPT, NODE };
+
+    int fd = -1;
+    std::string path;
+    CheckpointState replayed;
+
+    /// Records appended but not yet written; `append_mutex` keeps appends
+    /// cheap while `write_mutex` serializes writing and truncating
+    std::mutex append_mutex;
+    std::mutex write_mutex;
+    std::condition_variable wake;
+    std::vector<unsigned char> pending;
+    bool stop = false;
+    std::thread flusher;
+
+    void replay(const std::vector<unsigned char> &bytes, std::size_t &valid);
+    void append(RecordType type, const void *payload, std::uint16_t size);
+    void flush();
+    void run(std::chrono::milliseconds sync_interval);
+};
+
+} // namespace choros
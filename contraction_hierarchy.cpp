@@ -0,0 +1,297 @@
+#include "contraction_hierarchy.hpp"
+#include "navigation.hpp"
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace choros {
+
+namespace {
+
+/// Nodes a witness search may settle before giving up; giving up only adds
+/// a shortcut that was not strictly needed
+constexpr std::size_t WITNESS_SETTLE_LIMIT = 256;
+
+/// Arc of the graph that remains while contracting
+struct WorkArc {
+    NodeId to;
+    float weight;
+    std::uint32_t out; ///< Piece from the arc's owner to `to`
+    std::uint32_t in;  ///< Piece from `to` back to the owner
+};
+
+using WorkGraph = std::vector<std::vector<WorkArc>>;
+
+struct Shortcut {
+    NodeId from;
+    NodeId to;
+    float weight;
+    std::uint32_t first_out, second_out; ///< Pieces from `from` to `to`
+    std::uint32_t first_in, second_in;   ///< Pieces from `to` to `from`
+};
+
+/// Dijkstra from `source` over the remaining graph, avoiding `skip` and
+/// stopping beyond `bound`
+void witness_search(const WorkGraph &graph, NodeId source, NodeId skip,
+                    float bound, PathWorkspace &workspace) {
+    workspace.begin(graph.size());
+    workspace.set(source, 0.0f, PathWorkspace::NO_EDGE);
+    workspace.push(0.0f, source);
+
+    std::size_t settled = 0;
+    PathWorkspace::HeapEntry top{};
+    while (workspace.pop(top)) {
+        const NodeId u = top.node;
+        const float g = workspace.distance(u);
+        if (top.key > g)
+            continue;
+        if (g > bound || ++settled > WITNESS_SETTLE_LIMIT)
+            break;
+        for (const WorkArc &arc : graph[u]) {
+            if (arc.to == skip)
+                continue;
+            const float alt = g + arc.weight;
+            if (alt < workspace.distance(arc.to)) {
+                workspace.set(arc.to, alt, PathWorkspace::NO_EDGE);
+                workspace.push(alt, arc.to);
+            }
+        }
+    }
+}
+
+/// Collects the shortcuts needed to contract `node` into `shortcuts`
+void find_shortcuts(const WorkGraph &graph, NodeId node,
+                    PathWorkspace &workspace,
+                    std::vector<Shortcut> &shortcuts) {
+    shortcuts.clear();
+    const std::vector<WorkArc> &arcs = graph[node];
+    float longest = 0.0f;
+    for (const WorkArc &arc : arcs)
+        longest = std::max(longest, arc.weight);
+
+    // Arcs are symmetric, so each pair of neighbors is checked once
+    for (std::size_t i = 0; i + 1 < arcs.size(); ++i) {
+        witness_search(graph, arcs[i].to, node, arcs[i].weight + longest,
+                       workspace);
+        for (std::size_t j = i + 1; j < arcs.size(); ++j) {
+            const float via = arcs[i].weight + arcs[j].weight;
+            if (workspace.distance(arcs[j].to) <= via)
+                continue; // A witness path avoids `node`
+            shortcuts.push_back({arcs[i].to, arcs[j].to, via, arcs[i].in,
+                                 arcs[j].out, arcs[j].in, arcs[i].out});
+        }
+    }
+}
+
+/// Returns the arc from `from` to `to` in `graph`, or null
+WorkArc *find_arc(WorkGraph &graph, NodeId from, NodeId to) {
+    for (WorkArc &arc : graph[from]) {
+        if (arc.to == to)
+            return &arc;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy(const Navigation &navigation) {
+    if (!navigation.is_frozen())
+        throw std::logic_error(
+            "Building a contraction hierarchy requires a frozen graph.");
+
+    // The first pieces are the CSR edges themselves
+    const std::size_t n = navigation.node_count();
+    const std::size_t edge_count = navigation.edge_count();
+    pieces.reserve(edge_count * 2);
+    WorkGraph graph(n);
+    for (NodeId u = 0; u < n; ++u) {
+        for (std::uint32_t e = navigation.edges_begin(u);
+             e < navigation.edges_end(u); ++e) {
+            const CsrEdge &edge = navigation.csr_edge(e);
+            std::uint32_t back = NO_PIECE;
+            for (std::uint32_t r = navigation.edges_begin(edge.to);
+                 r < navigation.edges_end(edge.to); ++r) {
+                if (navigation.csr_edge(r).to == u)
+                    back = r;
+            }
+            if (back == NO_PIECE)
+                throw std::logic_error("Edge " + std::to_string(e) +
+                                       " has no reverse edge.");
+            pieces.push_back({e, NO_PIECE});
+            graph[u].push_back({edge.to, edge.weight, e, back});
+        }
+    }
+
+    // Contract nodes in order of edge difference plus contracted neighbors,
+    // re-evaluating lazily when popped
+    PathWorkspace workspace(n);
+    std::vector<Shortcut> found;
+    std::vector<int> contracted_neighbors(n, 0);
+    std::vector<char> contracted(n, 0);
+    auto priority = [&](NodeId node) {
+        find_shortcuts(graph, node, workspace, found);
+        return static_cast<int>(found.size()) -
+               static_cast<int>(graph[node].size()) +
+               contracted_neighbors[node];
+    };
+
+    using Entry = std::pair<int, NodeId>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (NodeId node = 0; node < n; ++node)
+        queue.push({priority(node), node});
+
+    std::vector<std::vector<Arc>> upward(n);
+    while (!queue.empty()) {
+        const NodeId node = queue.top().second;
+        queue.pop();
+        if (contracted[node])
+            continue;
+        const int current = priority(node);
+        if (!queue.empty() && current > queue.top().first) {
+            queue.push({current, node});
+            continue;
+        }
+
+        // `found` holds the shortcuts of `node` from `priority()`
+        for (const Shortcut &shortcut : found) {
+            WorkArc *forward = find_arc(graph, shortcut.from, shortcut.to);
+            if (forward && forward->weight <= shortcut.weight)
+                continue;
+            const auto out = static_cast<std::uint32_t>(pieces.size());
+            pieces.push_back({shortcut.first_out, shortcut.second_out});
+            pieces.push_back({shortcut.first_in, shortcut.second_in});
+            if (forward) {
+                WorkArc *backward = find_arc(graph, shortcut.to, shortcut.from);
+                *forward = {shortcut.to, shortcut.weight, out, out + 1};
+                *backward = {shortcut.from, shortcut.weight, out + 1, out};
+            } else {
+                graph[shortcut.from].push_back(
+                    {shortcut.to, shortcut.weight, out, out + 1});
+                graph[shortcut.to].push_back(
+                    {shortcut.from, shortcut.weight, out + 1, out});
+            }
+            ++shortcuts;
+        }
+
+        // The remaining neighbors are all contracted later, i.e. higher up
+        for (const WorkArc &arc : graph[node]) {
+            upward[node].push_back({arc.to, arc.weight, arc.out, arc.in});
+            std::vector<WorkArc> &back = graph[arc.to];
+            back.erase(std::find_if(back.begin(), back.end(),
+                                    [&](const WorkArc &other) {
+                                        return other.to == node;
+                                    }));
+            ++contracted_neighbors[arc.to];
+        }
+        graph[node] = {};
+        contracted[node] = 1;
+    }
+
+    offsets.resize(n + 1);
+    for (NodeId node = 0; node < n; ++node) {
+        offsets[node] = static_cast<std::uint32_t>(arcs.size());
+        for (const Arc &arc : upward[node]) {
+            arcs.push_back(arc);
+            arc_sources.push_back(node);
+        }
+    }
+    offsets[n] = static_cast<std::uint32_t>(arcs.size());
+}
+
+bool ContractionHierarchy::route(NodeId from, NodeId to,
+                                 PathWorkspace &workspace) const {
+    workspace.begin(node_count());
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+    reversed.clear();
+    if (from == to || from >= node_count() || to >= node_count())
+        return false;
+
+    // Both searches only climb; the shortest path peaks at the meeting node
+    thread_local PathWorkspace backward;
+    backward.begin(node_count());
+    workspace.set(from, 0.0f, PathWorkspace::NO_EDGE);
+    workspace.push(0.0f, from);
+    backward.set(to, 0.0f, PathWorkspace::NO_EDGE);
+    backward.push(0.0f, to);
+
+    float best = std::numeric_limits<float>::infinity();
+    NodeId meet = NO_NODE;
+    while (true) {
+        const float forward_key = workspace.min_key();
+        const float backward_key = backward.min_key();
+        if (std::min(forward_key, backward_key) >= best)
+            break;
+        const bool expanded =
+            forward_key <= backward_key
+                ? step(workspace, backward, best, meet)
+                : step(backward, workspace, best, meet);
+        if (expanded)
+            workspace.count_expansion();
+    }
+    if (meet == NO_NODE)
+        return false;
+
+    // Unpack from `to` back to `meet`, then from `meet` back to `from`
+    thread_local std::vector<std::uint32_t> descent;
+    descent.clear();
+    for (NodeId v = meet; v != to;) {
+        const std::uint32_t a = backward.parent_edge(v);
+        descent.push_back(arcs[a].down);
+        v = arc_sources[a];
+    }
+    for (auto it = descent.rbegin(); it != descent.rend(); ++it)
+        unpack(*it, reversed);
+    for (NodeId v = meet; v != from;) {
+        const std::uint32_t a = workspace.parent_edge(v);
+        unpack(arcs[a].up, reversed);
+        v = arc_sources[a];
+    }
+    return true;
+}
+
+bool ContractionHierarchy::step(PathWorkspace &side,
+                                const PathWorkspace &other, float &best,
+                                NodeId &meet) const {
+    PathWorkspace::HeapEntry top{};
+    side.pop(top);
+    const NodeId u = top.node;
+    const float g = side.distance(u);
+    if (top.key > g)
+        return false; // Stale heap entry
+
+    for (std::uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+        const Arc &arc = arcs[a];
+        const float alt = g + arc.weight;
+        if (alt < side.distance(arc.to)) {
+            side.set(arc.to, alt, a);
+            side.push(alt, arc.to);
+            const float through = alt + other.distance(arc.to);
+            if (through < best) {
+                best = through;
+                meet = arc.to;
+            }
+        }
+    }
+    return true;
+}
+
+void ContractionHierarchy::unpack(std::uint32_t piece,
+                                  std::vector<std::uint32_t> &out) const {
+    // Expand the second half first, so the last edge comes out first
+    thread_local std::vector<std::uint32_t> stack;
+    stack.clear();
+    stack.push_back(piece);
+    while (!stack.empty()) {
+        const Piece &top = pieces[stack.back()];
+        stack.pop_back();
+        if (top.second == NO_PIECE) {
+            out.push_back(top.first);
+            continue;
+        }
+        stack.push_back(top.first);
+        stack.push_back(top.second);
+    }
+}
+
+} // namespace choros
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "path_workspace.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace choros {
+
+class Navigation;
+
+/**
+ * @brief Contraction hierarchy over a frozen `Navigation` graph.
+ *
+ * Preprocessing contracts the nodes one by one, least important first, and
+ * adds a shortcut between two neighbors of a contracted node whenever the
+ * route through it is the only shortest one. A query then runs two small
+ * Dijkstra searches that only climb towards more important nodes, settling
+ * a few hundred nodes instead of a large part of the graph. Every shortcut
+ * remembers the two arcs it replaces, so paths unpack into the original CSR
+ * edges, with their directions and intersection flags.
+ *
+ * Built by `Navigation::build_contraction_hierarchy()` and used for queries
+ * with an empty blacklist. It relies on every edge having a reverse edge of
+ * the same weight, which `Navigation::add_edge()` guarantees, and refers to
+ * the graph only by node ID and CSR index, so it is valid for any copy of
+ * that graph. Queries are thread-safe.
+ */
+class ContractionHierarchy {
+  public:
+    /**
+     * @brief Contracts every node of `navigation`.
+     *
+     * Throws `std::logic_error` if the graph is not frozen.
+     */
+    explicit ContractionHierarchy(const Navigation &navigation);
+
+    /// Returns the number of nodes of the graph.
+    std::size_t node_count() const { return offsets.size() - 1; }
+
+    /// Returns the number of shortcuts added by the contraction.
+    std::size_t shortcut_count() const { return shortcuts; }
+
+    /**
+     * @brief Finds a shortest path between two nodes.
+     *
+     * On success the path's CSR edges are in `workspace.path_edges()`,
+     * last edge first, as left by the searches of `Navigation`. Like
+     * `Navigation::find_path()`, finds no path from a node to itself;
+     * unknown IDs have no path either. The backward search runs in a
+     * thread-local workspace.
+     */
+    bool route(NodeId from, NodeId to, PathWorkspace &workspace) const;
+
+  private:
+    /// Shortcut or original edge, in one direction. An original edge has
+    /// `second == NO_PIECE` and its CSR index in `first`; a shortcut is
+    /// piece `first` followed by piece `second`.
+    struct Piece {
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    static constexpr std::uint32_t NO_PIECE = PathWorkspace::NO_EDGE;
+
+    /// Arc to a more important node, with the pieces leading there and
+    /// back
+    struct Arc {
+        NodeId to;
+        float weight;
+        std::uint32_t up;   ///< Piece from the arc's source to `to`
+        std::uint32_t down; ///< Piece from `to` back to the source
+    };
+
+    /// Upward arcs of node `n` are `arcs[offsets[n] .. offsets[n + 1])`
+    std::vector<std::uint32_t> offsets;
+    std::vector<Arc> arcs;
+    std::vector<NodeId> arc_sources;
+    std::vector<Piece> pieces;
+    std::size_t shortcuts = 0;
+
+    /// Pops a node off `side` and relaxes its upward arcs, updating the
+    /// best meeting node against `other`; returns false for a stale entry.
+    bool step(PathWorkspace &side, const PathWorkspace &other, float &best,
+              NodeId &meet) const;
+
+    /// Appends the CSR edges of `piece` to `out`, last edge first.
+    void unpack(std::uint32_t piece, std::vector<std::uint32_t> &out) const;
+};
+
+} // namespace choros
@@ -0,0 +1,278 @@
+#include "cooperative_planner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace choros {
+
+namespace {
+
+constexpr std::uint32_t UNREACHABLE = std::numeric_limits<std::uint32_t>::max();
+
+std::uint64_t state_key(NodeId node, std::uint32_t step) {
+    return (static_cast<std::uint64_t>(node) << 32) | step;
+}
+
+NodeId state_node(std::uint64_t state) {
+    return static_cast<NodeId>(state >> 32);
+}
+
+std::uint32_t state_step(std::uint64_t state) {
+    return static_cast<std::uint32_t>(state);
+}
+
+} // namespace
+
+std::uint64_t ReservationTable::node_key(NodeId node, std::uint32_t step) {
+    return state_key(node, step);
+}
+
+std::uint64_t ReservationTable::edge_key(NodeId a, NodeId b) {
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+bool ReservationTable::node_free(NodeId node, std::uint32_t step,
+                                 RobotId robot) const {
+    auto park = parked.find(node);
+    if (park != parked.end() && park->second.robot != robot &&
+        park->second.since <= step)
+        return false;
+    auto it = nodes.find(node_key(node, step));
+    return it == nodes.end() || it->second == robot;
+}
+
+bool ReservationTable::edge_free(NodeId a, NodeId b, std::uint32_t step,
+                                 RobotId robot) const {
+    auto it = edges.find({edge_key(a, b), step});
+    return it == edges.end() || it->second == robot;
+}
+
+bool ReservationTable::can_park(NodeId node, std::uint32_t step,
+                                RobotId robot) const {
+    auto park = parked.find(node);
+    if (park != parked.end() && park->second.robot != robot)
+        return false;
+    auto last = latest.find(node);
+    if (last == latest.end())
+        return true;
+    for (std::uint32_t s = step; s <= last->second; ++s) {
+        if (!node_free(node, s, robot))
+            return false;
+    }
+    return true;
+}
+
+void ReservationTable::reserve_node(RobotId robot, NodeId node,
+                                    std::uint32_t step) {
+    const std::uint64_t key = node_key(node, step);
+    if (!nodes.emplace(key, robot).second)
+        return;
+    held[robot].nodes.push_back(key);
+    std::uint32_t &last = latest[node];
+    last = std::max(last, step);
+}
+
+void ReservationTable::reserve_edge(RobotId robot, NodeId a, NodeId b,
+                                    std::uint32_t step) {
+    const EdgeSlot slot{edge_key(a, b), step};
+    if (edges.emplace(slot, robot).second)
+        held[robot].edges.push_back(slot);
+}
+
+void ReservationTable::park(RobotId robot, NodeId node, std::uint32_t since) {
+    parked[node] = {robot, since};
+    held[robot].parked = node;
+}
+
+void ReservationTable::release(RobotId robot) {
+    auto it = held.find(robot);
+    if (it == held.end())
+        return;
+    for (std::uint64_t key : it->second.nodes)
+        nodes.erase(key);
+    for (const EdgeSlot &slot : it->second.edges)
+        edges.erase(slot);
+    if (it->second.parked.has_value())
+        parked.erase(it->second.parked.value());
+    held.erase(it);
+
+    // Rebuild the per-node bounds; stale ones would only be conservative
+    latest.clear();
+    for (const auto &[key, _] : nodes) {
+        std::uint32_t &last = latest[state_node(key)];
+        last = std::max(last, state_step(key));
+    }
+}
+
+void ReservationTable::clear() {
+    nodes.clear();
+    edges.clear();
+    parked.clear();
+    latest.clear();
+    held.clear();
+}
+
+CooperativePlanner::CooperativePlanner(const Navigation &navigation,
+                                       float time_step, std::uint32_t horizon)
+    : navigation(navigation), step_duration(time_step), horizon(horizon) {
+    if (!navigation.is_frozen())
+        throw std::logic_error("Cooperative planning requires a frozen graph.");
+    if (!(time_step > 0.0f))
+        throw std::invalid_argument("Time step must be positive.");
+
+    edge_steps.resize(navigation.edge_count());
+    for (std::uint32_t e = 0; e < edge_steps.size(); ++e) {
+        const float weight = navigation.csr_edge(e).weight;
+        edge_steps[e] = std::max<std::uint32_t>(
+            1, static_cast<std::uint32_t>(std::ceil(weight / time_step)));
+    }
+}
+
+void CooperativePlanner::compute_heuristic(NodeId goal) {
+    if (heuristic_goal == goal)
+        return;
+
+    // Dijkstra from the goal; edges are symmetric, so forward edges serve
+    remaining.assign(navigation.node_count(), UNREACHABLE);
+    using Entry = std::pair<std::uint32_t, NodeId>;
+    std::vector<Entry> heap;
+    remaining[goal] = 0;
+    heap.emplace_back(0, goal);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        const auto [steps, node] = heap.back();
+        heap.pop_back();
+        if (steps > remaining[node])
+            continue;
+        for (std::uint32_t e = navigation.edges_begin(node);
+             e < navigation.edges_end(node); ++e) {
+            const NodeId next = navigation.csr_edge(e).to;
+            const std::uint32_t alt = steps + edge_steps[e];
+            if (alt < remaining[next]) {
+                remaining[next] = alt;
+                heap.emplace_back(alt, next);
+                std::push_heap(heap.begin(), heap.end(),
+                               std::greater<Entry>());
+            }
+        }
+    }
+    heuristic_goal = goal;
+}
+
+bool CooperativePlanner::move_free(RobotId robot, std::uint32_t edge,
+                                   std::uint32_t step) const {
+    const NodeId from = navigation.edge_source(edge);
+    const NodeId to = navigation.csr_edge(edge).to;
+    for (std::uint32_t s = step; s < step + edge_steps[edge]; ++s) {
+        if (!table.edge_free(from, to, s, robot))
+            return false;
+    }
+    return table.node_free(to, step + edge_steps[edge], robot);
+}
+
+std::optional<TimedPath> CooperativePlanner::plan(RobotId robot,
+                                                  const std::string &from,
+                                                  const std::string &to,
+                                                  std::uint32_t start) {
+    table.release(robot);
+    expanded = 0;
+    auto source = navigation.node_id(from);
+    auto goal = navigation.node_id(to);
+    if (!source.has_value() || !goal.has_value() ||
+        !table.node_free(source.value(), start, robot))
+        return std::nullopt;
+
+    compute_heuristic(goal.value());
+    if (remaining[source.value()] == UNREACHABLE)
+        return std::nullopt;
+
+    visited.clear();
+    queue.clear();
+    const std::uint32_t deadline = start + horizon;
+    auto visit = [&](NodeId node, std::uint32_t step, std::uint64_t parent,
+                     std::uint32_t edge) {
+        if (remaining[node] == UNREACHABLE ||
+            !visited.emplace(state_key(node, step), Visit{parent, edge})
+                 .second)
+            return;
+        queue.push_back({step + remaining[node], step, node});
+        std::push_heap(queue.begin(), queue.end(),
+                       std::greater<QueueEntry>());
+    };
+    visit(source.value(), start, 0, PathWorkspace::NO_EDGE);
+
+    // A state's cost is its step, so the first visit of a state is final
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+        const QueueEntry top = queue.back();
+        queue.pop_back();
+        const std::uint64_t state = state_key(top.node, top.step);
+        if (top.node == goal.value() &&
+            table.can_park(top.node, top.step, robot))
+            return reserve(robot, source.value(), start, state);
+        if (top.key > deadline)
+            break;
+        ++expanded;
+
+        if (table.node_free(top.node, top.step + 1, robot))
+            visit(top.node, top.step + 1, state, PathWorkspace::NO_EDGE);
+        for (std::uint32_t e = navigation.edges_begin(top.node);
+             e < navigation.edges_end(top.node); ++e) {
+            if (move_free(robot, e, top.step))
+                visit(navigation.csr_edge(e).to, top.step + edge_steps[e],
+                      state, e);
+        }
+    }
+    return std::nullopt;
+}
+
+TimedPath CooperativePlanner::reserve(RobotId robot, NodeId from,
+                                      std::uint32_t start,
+                                      std::uint64_t goal_state) {
+    TimedPath path;
+    path.start = start;
+    path.arrival = state_step(goal_state);
+
+    // Walk back to the start, reserving every state and traversal
+    for (std::uint64_t state = goal_state;;) {
+        table.reserve_node(robot, state_node(state), state_step(state));
+        if (state == state_key(from, start))
+            break;
+        const Visit &how = visited.at(state);
+        if (how.edge != PathWorkspace::NO_EDGE) {
+            const NodeId source = navigation.edge_source(how.edge);
+            const NodeId target = navigation.csr_edge(how.edge).to;
+            for (std::uint32_t s = state_step(how.parent);
+                 s < state_step(state); ++s)
+                table.reserve_edge(robot, source, target, s);
+            path.steps.push_back({navigation.edge_at(how.edge),
+                                  state_step(how.parent), state_step(state)});
+        }
+        state = how.parent;
+    }
+    table.park(robot, state_node(goal_state), path.arrival);
+    std::reverse(path.steps.begin(), path.steps.end());
+    return path;
+}
+
+std::vector<std::optional<TimedPath>>
+CooperativePlanner::plan_all(const std::vector<Request> &requests) {
+    // Robots planned later still stand at their start when earlier ones set
+    // off, so keep those nodes clear for the start step
+    for (const Request &request : requests) {
+        table.release(request.robot);
+        auto node = navigation.node_id(request.from);
+        if (node.has_value())
+            table.reserve_node(request.robot, node.value(), request.start);
+    }
+    std::vector<std::optional<TimedPath>> paths;
+    paths.reserve(requests.size());
+    for (const Request &request : requests)
+        paths.push_back(
+            plan(request.robot, request.from, request.to, request.start));
+    return paths;
+}
+
+} // namespace choros
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "navigation.hpp"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace choros {
+
+/// Identifier of a robot taking part in cooperative planning.
+using RobotId = std::uint32_t;
+
+/**
+ * @brief One edge of a timed path, with its departure and arrival step.
+ *
+ * A robot waits at a node between the arrival of one step and the departure
+ * of the next.
+ */
+struct TimedStep {
+    Edge edge;
+    std::uint32_t depart;
+    std::uint32_t arrive;
+};
+
+/**
+ * @brief A path with timing, from `CooperativePlanner::plan()`.
+ *
+ * Times are discrete steps of `CooperativePlanner::time_step()`.
+ */
+struct TimedPath {
+    std::vector<TimedStep> steps;
+    std::uint32_t start = 0;   ///< Step at which the robot stands at its start
+    std::uint32_t arrival = 0; ///< Step from which it parks at its goal
+};
+
+/**
+ * @brief Space-time reservations of nodes and edges by robots.
+ *
+ * Time is discrete. A robot occupies a node at every step it stands there,
+ * including its departure and arrival steps, and an edge (in both
+ * directions, as lanes are narrow) at every step it spends traversing it. A
+ * robot that reached its goal parks there indefinitely.
+ *
+ * The table is not thread-safe.
+ */
+class ReservationTable {
+  public:
+    /// Returns true if no robot other than `robot` occupies `node` at `step`.
+    bool node_free(NodeId node, std::uint32_t step, RobotId robot) const;
+
+    /// Returns true if no robot other than `robot` traverses the edge
+    /// between `a` and `b`, in either direction, at `step`.
+    bool edge_free(NodeId a, NodeId b, std::uint32_t step,
+                   RobotId robot) const;
+
+    /// Returns true if `robot` may occupy `node` from `step` on forever.
+    bool can_park(NodeId node, std::uint32_t step, RobotId robot) const;
+
+    void reserve_node(RobotId robot, NodeId node, std::uint32_t step);
+    void reserve_edge(RobotId robot, NodeId a, NodeId b, std::uint32_t step);
+    void park(RobotId robot, NodeId node, std::uint32_t since);
+
+    /// Drops every reservation held by `robot`.
+    void release(RobotId robot);
+
+    /// Drops every reservation.
+    void clear();
+
+  private:
+    struct EdgeSlot {
+        std::uint64_t edge; ///< (min << 32 | max) endpoint IDs
+        std::uint32_t step;
+
+        bool operator==(const EdgeSlot &other) const {
+            return edge == other.edge && step == other.step;
+        }
+    };
+
+    struct EdgeSlotHash {
+        std::size_t operator()(const EdgeSlot &slot) const {
+            return std::hash<std::uint64_t>()(slot.edge * 31 + slot.step);
+        }
+    };
+
+    struct Parking {
+        RobotId robot;
+        std::uint32_t since;
+    };
+
+    /// Reservations held by one robot, for `release()`
+    struct Held {
+        std::vector<std::uint64_t> nodes;
+        std::vector<EdgeSlot> edges;
+        std::optional<NodeId> parked;
+    };
+
+    static std::uint64_t node_key(NodeId node, std::uint32_t step);
+    static std::uint64_t edge_key(NodeId a, NodeId b);
+
+    std::unordered_map<std::uint64_t, RobotId> nodes;
+    std::unordered_map<EdgeSlot, RobotId, EdgeSlotHash> edges;
+    std::unordered_map<NodeId, Parking> parked;
+    /// Latest reserved step per node, bounding `can_park()`
+    std::unordered_map<NodeId, std::uint32_t> latest;
+    std::unordered_map<RobotId, Held> held;
+};
+
+/**
+ * @brief Conflict-free path planning for several robots on one field.
+ *
+ * Plans each robot with time-expanded A* over (node, step) states against a
+ * shared `ReservationTable`, then reserves the result, so robots planned
+ * later route and time themselves around robots planned earlier
+ * (prioritized planning). Instead of avoiding each other's nodes entirely,
+ * robots may wait and pass through shared intersections one after another.
+ *
+ * Edge weights are treated as travel times: traversing an edge takes
+ * `ceil(weight / time_step)` steps, at least one. The planner keeps a
+ * reference to `navigation`, which must be frozen and must outlive the
+ * planner. Like `IncrementalPlanner`, it relies on every edge having a
+ * reverse edge of the same weight.
+ */
+class CooperativePlanner {
+  public:
+    /// A robot's planning request for `plan_all()`
+    struct Request {
+        RobotId robot;
+        std::string from;
+        std::string to;
+        std::uint32_t start = 0;
+    };
+
+    /**
+     * @brief Creates a planner.
+     *
+     * Throws `std::logic_error` if the graph is not frozen and
+     * `std::invalid_argument` unless `time_step` is positive.
+     *
+     * @param navigation Frozen field graph
+     * @param time_step Duration of one step, in the unit of edge weights
+     * @param horizon Maximum number of steps a plan may take
+     */
+    CooperativePlanner(const Navigation &navigation, float time_step,
+                       std::uint32_t horizon = 512);
+
+    /**
+     * @brief Plans and reserves a path for one robot.
+     *
+     * Replaces any reservations `robot` held before. Returns the fastest
+     * path that conflicts with no other robot's reservations and ends with
+     * the robot parked at `to`, or nullopt if there is none within the
+     * horizon or either node is unknown. If `from == to` the path has no
+     * steps and only parks the robot.
+     *
+     * @param robot Robot to plan for
+     * @param from Node the robot stands at on step `start`
+     * @param to Goal node
+     * @param start Step at which the robot sets off
+     */
+    std::optional<TimedPath> plan(RobotId robot, const std::string &from,
+                                  const std::string &to,
+                                  std::uint32_t start = 0);
+
+    /**
+     * @brief Plans several robots in priority order.
+     *
+     * Releases all requested robots first, then plans them one after
+     * another; earlier requests have priority.
+     */
+    std::vector<std::optional<TimedPath>>
+    plan_all(const std::vector<Request> &requests);
+
+    /// Drops the reservations of `robot`, e.g. once it finished its path.
+    void release(RobotId robot) { table.release(robot); }
+
+    /// Returns the shared reservation table.
+    ReservationTable &reservations() { return table; }
+    const ReservationTable &reservations() const { return table; }
+
+    /// Returns the duration of one step.
+    float time_step() const { return step_duration; }
+
+    /// Returns how many states the last plan expanded.
+    std::size_t expanded_nodes() const { return expanded; }
+
+  private:
+    /// How a state was reached; waiting uses `PathWorkspace::NO_EDGE`
+    struct Visit {
+        std::uint64_t parent;
+        std::uint32_t edge;
+    };
+
+    struct QueueEntry {
+        std::uint32_t key; ///< Step plus remaining steps to the goal
+        std::uint32_t step;
+        NodeId node;
+
+        bool operator>(const QueueEntry &other) const {
+            // Among equal keys, prefer later steps, i.e. closer to the goal
+            return key != other.key ? key > other.key : step < other.step;
+        }
+    };
+
+    const Navigation &navigation;
+    float step_duration;
+    std::uint32_t horizon;
+    ReservationTable table;
+
+    /// Steps needed to traverse each CSR edge
+    std::vector<std::uint32_t> edge_steps;
+    /// Steps from each node to `heuristic_goal`, ignoring other robots
+    std::vector<std::uint32_t> remaining;
+    NodeId heuristic_goal = NO_NODE;
+
+    std::unordered_map<std::uint64_t, Visit> visited;
+    std::vector<QueueEntry> queue;
+    std::size_t expanded = 0;
+
+    void compute_heuristic(NodeId goal);
+    bool move_free(RobotId robot, std::uint32_t edge,
+                   std::uint32_t step) const;
+    TimedPath reserve(RobotId robot, NodeId from, std::uint32_t start,
+                      std::uint64_t goal_state);
+};
+
+} // namespace choros
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+
+namespace choros {
+
+class Navigation;
+
+/**
+ * @brief A path as CSR edge indices into a frozen `Navigation`.
+ *
+ * The zero-copy counterpart of `std::vector<Edge>`: no edge or node name
+ * is copied, edge `e` resolves through `Navigation::csr_edge(e)` and its
+ * target name through `Navigation::node_name()`. Up to `INLINE_CAPACITY`
+ * edges are stored inline; longer paths spill into a heap buffer that is
+ * kept when the path is refilled, so replanning into the same `EdgePath`
+ * does not allocate. The indices refer to the graph that produced them.
+ */
+class EdgePath {
+  public:
+    static constexpr std::size_t INLINE_CAPACITY = 16;
+
+    EdgePath() = default;
+
+    EdgePath(const EdgePath &other) { *this = other; }
+
+    EdgePath(EdgePath &&other) noexcept { *this = std::move(other); }
+
+    EdgePath &operator=(const EdgePath &other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+            length = other.length;
+        }
+        return *this;
+    }
+
+    EdgePath &operator=(EdgePath &&other) noexcept {
+        if (this == &other)
+            return *this;
+        if (other.heap) {
+            heap = std::move(other.heap);
+            heap_capacity = other.heap_capacity;
+            other.heap_capacity = 0;
+        } else {
+            std::copy(other.begin(), other.end(), local);
+            heap.reset();
+            heap_capacity = 0;
+        }
+        count = other.count;
+        length = other.length;
+        other.count = 0;
+        other.length = 0.0f;
+        return *this;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::size_t capacity() const {
+        return heap ? heap_capacity : INLINE_CAPACITY;
+    }
+
+    /// Edge indices, first edge first.
+    const std::uint32_t *data() const { return heap ? heap.get() : local; }
+    std::uint32_t operator[](std::size_t index) const { return data()[index]; }
+    const std::uint32_t *begin() const { return data(); }
+    const std::uint32_t *end() const { return data() + count; }
+    std::uint32_t front() const { return data()[0]; }
+    std::uint32_t back() const { return data()[count - 1]; }
+
+    /// Returns the edge indices as a span.
+    std::span<const std::uint32_t> edges() const { return {data(), count}; }
+
+    /// Returns the summed edge weight of the path.
+    float distance() const { return length; }
+
+    /// Empties the path, keeping its capacity.
+    void clear() {
+        count = 0;
+        length = 0.0f;
+    }
+
+    /// Ensures room for `edges` indices without further allocation.
+    void reserve(std::size_t edges) {
+        if (edges <= capacity())
+            return;
+        auto grown = std::make_unique<std::uint32_t[]>(edges);
+        std::copy(begin(), end(), grown.get());
+        heap = std::move(grown);
+        heap_capacity = edges;
+    }
+
+    /// Replaces the indices with `[first, last)`; the distance is kept.
+    template <typename It> void assign(It first, It last) {
+        const auto edges = static_cast<std::size_t>(std::distance(first, last));
+        count = 0;
+        reserve(edges);
+        std::copy(first, last, heap ? heap.get() : local);
+        count = edges;
+    }
+
+  private:
+    friend class Navigation;
+
+    std::uint32_t local[INLINE_CAPACITY];
+    std::unique_ptr<std::uint32_t[]> heap;
+    std::size_t heap_capacity = 0;
+    std::size_t count = 0;
+    float length = 0.0f;
+};
+
+} // namespace choros
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+namespace choros {
+
+/**
+ * @brief Append-only array whose elements never move.
+ *
+ * Elements live in segments of doubling size that are allocated on demand
+ * and never freed before destruction, so references stay valid and other
+ * threads may read any index below `size()` while one thread appends. Only
+ * appends must be serialized. Used for lifecycle state that telemetry
+ * threads poll while tasks are being inserted.
+ */
+template <typename T> class GrowableArray {
+  public:
+    GrowableArray() = default;
+    GrowableArray(const GrowableArray &) = delete;
+    GrowableArray &operator=(const GrowableArray &) = delete;
+
+    ~GrowableArray() {
+        for (auto &segment : segments)
+            delete[] segment.load(std::memory_order_relaxed);
+    }
+
+    /// Number of elements; elements below it are safe to read.
+    std::size_t size() const { return count.load(std::memory_order_acquire); }
+
+    T &operator[](std::size_t index) { return *locate(index); }
+    const T &operator[](std::size_t index) const { return *locate(index); }
+
+    /**
+     * @brief Appends a value-initialized element and returns it.
+     *
+     * Must not be called concurrently with another `emplace_back()`.
+     */
+    T &emplace_back() {
+        const std::size_t index = count.load(std::memory_order_relaxed);
+        const std::size_t segment = segment_of(index);
+        if (segments[segment].load(std::memory_order_relaxed) == nullptr)
+            segments[segment].store(new T[FIRST_SEGMENT << segment](),
+                                    std::memory_order_release);
+        T &element = *locate(index);
+        count.store(index + 1, std::memory_order_release);
+        return element;
+    }
+
+  private:
+    static constexpr std::size_t FIRST_SEGMENT = 64;
+    static constexpr std::size_t MAX_SEGMENTS = 32;
+
+    /// Segment `s` holds indices `[FIRST * (2^s - 1), FIRST * (2^(s+1) - 1))`
+    static std::size_t segment_of(std::size_t index) {
+        return std::bit_width(index / FIRST_SEGMENT + 1) - 1;
+    }
+
+    T *locate(std::size_t index) const {
+        const std::size_t segment = segment_of(index);
+        const std::size_t start =
+            FIRST_SEGMENT * ((std::size_t{1} << segment) - 1);
+        return segments[segment].load(std::memory_order_acquire) +
+               (index - start);
+    }
+
+    std::atomic<T *> segments[MAX_SEGMENTS] = {};
+    std::atomic<std::size_t> count{0};
+};
+
+} // namespace choros
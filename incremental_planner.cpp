@@ -0,0 +1,186 @@
+#include "incremental_planner.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace choros {
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+
+} // namespace
+
+IncrementalPlanner::IncrementalPlanner(const Navigation &navigation,
+                                       const std::string &goal)
+    : navigation(navigation) {
+    if (!navigation.is_frozen())
+        throw std::logic_error("Incremental planning requires a frozen graph.");
+    auto id = navigation.node_id(goal);
+    if (!id.has_value())
+        throw std::invalid_argument("Unknown goal node: " + goal);
+    this->goal = id.value();
+
+    const std::size_t n = navigation.node_count();
+    g.assign(n, INF);
+    rhs.assign(n, INF);
+    blocked.assign(n, 0);
+    rhs[this->goal] = 0.0f;
+    push(this->goal);
+}
+
+float IncrementalPlanner::key(NodeId node) const {
+    return std::min(g[node], rhs[node]);
+}
+
+bool IncrementalPlanner::is_stale(const QueueEntry &entry) const {
+    return g[entry.node] == rhs[entry.node] || entry.key != key(entry.node);
+}
+
+void IncrementalPlanner::push(NodeId node) {
+    queue.push_back({key(node), node});
+    std::push_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+}
+
+void IncrementalPlanner::update_vertex(NodeId node) {
+    if (node != goal) {
+        float best = INF;
+        if (!blocked[node]) {
+            for (std::uint32_t e = navigation.edges_begin(node);
+                 e < navigation.edges_end(node); ++e) {
+                const CsrEdge &edge = navigation.csr_edge(e);
+                if (!blocked[edge.to])
+                    best = std::min(best, edge.weight + g[edge.to]);
+            }
+        }
+        rhs[node] = best;
+    }
+    if (g[node] != rhs[node])
+        push(node);
+}
+
+void IncrementalPlanner::update_neighbors(NodeId node) {
+    // Edges are symmetric, so the successors of `node` are its predecessors
+    for (std::uint32_t e = navigation.edges_begin(node);
+         e < navigation.edges_end(node); ++e)
+        update_vertex(navigation.csr_edge(e).to);
+}
+
+void IncrementalPlanner::set_blocked(NodeId node, bool value) {
+    if (static_cast<bool>(blocked[node]) == value)
+        return;
+    blocked[node] = value;
+    if (node == goal)
+        rhs[goal] = value ? INF : 0.0f;
+    update_vertex(node);
+    update_neighbors(node);
+}
+
+void IncrementalPlanner::block(const std::string &node) {
+    auto id = navigation.node_id(node);
+    if (id.has_value())
+        set_blocked(id.value(), true);
+}
+
+void IncrementalPlanner::unblock(const std::string &node) {
+    auto id = navigation.node_id(node);
+    if (id.has_value())
+        set_blocked(id.value(), false);
+}
+
+void IncrementalPlanner::set_blacklist(
+    const std::unordered_set<std::string> &blacklist) {
+    std::vector<char> wanted(blocked.size(), 0);
+    for (const auto &node : blacklist) {
+        auto id = navigation.node_id(node);
+        if (id.has_value())
+            wanted[id.value()] = 1;
+    }
+    for (NodeId id = 0; id < blocked.size(); ++id) {
+        if (wanted[id] != blocked[id])
+            set_blocked(id, wanted[id]);
+    }
+}
+
+bool IncrementalPlanner::is_blocked(const std::string &node) const {
+    auto id = navigation.node_id(node);
+    return id.has_value() && blocked[id.value()];
+}
+
+void IncrementalPlanner::compute_shortest_path(NodeId start) {
+    expanded = 0;
+    while (!queue.empty()) {
+        const QueueEntry top = queue.front();
+        if (is_stale(top)) {
+            std::pop_heap(queue.begin(), queue.end(),
+                          std::greater<QueueEntry>());
+            queue.pop_back();
+            continue;
+        }
+        if (top.key >= key(start) && g[start] == rhs[start])
+            break;
+
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+        queue.pop_back();
+        ++expanded;
+
+        const NodeId u = top.node;
+        if (g[u] > rhs[u]) {
+            g[u] = rhs[u];
+        } else {
+            g[u] = INF;
+            update_vertex(u);
+        }
+        update_neighbors(u);
+    }
+}
+
+std::optional<std::vector<Edge>> IncrementalPlanner::find_path() {
+    auto current = navigation.get_node();
+    if (!current.has_value())
+        return std::nullopt;
+    return find_path(current.value());
+}
+
+std::optional<std::vector<Edge>>
+IncrementalPlanner::find_path(const std::string &from) {
+    auto id = navigation.node_id(from);
+    if (!id.has_value())
+        return std::nullopt;
+    const NodeId start = id.value();
+    if (start == goal || blocked[start])
+        return std::nullopt;
+
+    compute_shortest_path(start);
+    if (g[start] == INF)
+        return std::nullopt;
+
+    // Descend the cost-to-goal field greedily
+    std::vector<Edge> path;
+    NodeId current = start;
+    while (current != goal) {
+        if (path.size() >= navigation.node_count())
+            return std::nullopt; // Should not happen
+        std::uint32_t best_edge = PathWorkspace::NO_EDGE;
+        float best = INF;
+        for (std::uint32_t e = navigation.edges_begin(current);
+             e < navigation.edges_end(current); ++e) {
+            const CsrEdge &edge = navigation.csr_edge(e);
+            if (blocked[edge.to])
+                continue;
+            float cost = edge.weight + g[edge.to];
+            if (cost < best) {
+                best = cost;
+                best_edge = e;
+            }
+        }
+        if (best_edge == PathWorkspace::NO_EDGE)
+            return std::nullopt;
+        path.push_back(navigation.edge_at(best_edge));
+        current = navigation.csr_edge(best_edge).to;
+    }
+    return path;
+}
+
+} // namespace choros
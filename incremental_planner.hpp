@@ -0,0 +1,101 @@
+#pragma once
+
+#include "navigation.hpp"
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Incremental shortest-path planner towards a fixed goal.
+ *
+ * Maintains a backward Lifelong Planning A* search (D* Lite without a
+ * heuristic) rooted at the goal. When nodes become blocked or unblocked,
+ * only the part of the shortest-path tree whose costs actually changed is
+ * repaired, so replanning after a one-node blacklist change is much cheaper
+ * than a fresh `Navigation::find_path()`. Because the search runs from the
+ * goal, the start node may change freely between queries.
+ *
+ * The planner keeps a reference to `navigation`, which must be frozen and
+ * must outlive the planner. It relies on every edge having a reverse edge of
+ * the same weight, which `Navigation::add_edge()` guarantees.
+ */
+class IncrementalPlanner {
+  public:
+    /**
+     * @brief Creates a planner for paths ending at `goal`.
+     *
+     * Throws `std::logic_error` if the graph is not frozen and
+     * `std::invalid_argument` if the goal is unknown.
+     */
+    IncrementalPlanner(const Navigation &navigation, const std::string &goal);
+
+    /**
+     * @brief Marks a node as impassable. Unknown nodes are ignored.
+     */
+    void block(const std::string &node);
+
+    /**
+     * @brief Makes a previously blocked node passable again.
+     */
+    void unblock(const std::string &node);
+
+    /**
+     * @brief Replaces the set of blocked nodes, applying only the difference.
+     */
+    void set_blacklist(const std::unordered_set<std::string> &blacklist);
+
+    /**
+     * @brief Returns true if a node is currently blocked.
+     */
+    bool is_blocked(const std::string &node) const;
+
+    /**
+     * @brief Finds a shortest path from the navigation's current node.
+     */
+    std::optional<std::vector<Edge>> find_path();
+
+    /**
+     * @brief Finds a shortest path from `from` to the goal.
+     *
+     * Follows the same conventions as `Navigation::find_path()`: no path is
+     * returned if `from` is the goal, or if either endpoint is blocked.
+     */
+    std::optional<std::vector<Edge>> find_path(const std::string &from);
+
+    /**
+     * @brief Returns how many nodes the last query had to expand.
+     */
+    std::size_t expanded_nodes() const { return expanded; }
+
+  private:
+    struct QueueEntry {
+        float key;
+        NodeId node;
+
+        bool operator>(const QueueEntry &other) const {
+            return key > other.key;
+        }
+    };
+
+    const Navigation &navigation;
+    NodeId goal;
+
+    std::vector<float> g;
+    std::vector<float> rhs;
+    std::vector<char> blocked;
+    std::vector<QueueEntry> queue; ///< Min-heap with lazy deletion
+    std::size_t expanded = 0;
+
+    float key(NodeId node) const;
+    bool is_stale(const QueueEntry &entry) const;
+    void push(NodeId node);
+    void update_vertex(NodeId node);
+    void update_neighbors(NodeId node);
+    void set_blocked(NodeId node, bool value);
+    void compute_shortest_path(NodeId start);
+};
+
+} // namespace choros
@@ -1,78 +1,916 @@
 #include "lifecycle.hpp"
+#include "async_task.hpp"
+#include "checkpoint.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <stdexcept>
+#include <thread>
 
 namespace choros {
 
-void Lifecycle::add_task(const std::string &id, std::shared_ptr<Task> task) {
-    task_map[id] = task;
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Ready queue that also holds tasks waiting out a retry backoff.
+ *
+ * Due tasks are served best rank first (`Rank::before()`), ties broken by
+ * arrival order; delayed tasks sit in a min-heap keyed by their wake-up time
+ * until `promote()` makes them due.
+ */
+template <typename Rank> class ReadyQueue {
+  public:
+    explicit ReadyQueue(const std::vector<Rank> &ranks) : ranks(ranks) {}
+
+    void push(TaskHandle task) {
+        ready.push_back({ranks[task], next_seq++, task});
+        std::push_heap(ready.begin(), ready.end(), after);
+    }
+
+    void push_at(TaskHandle task, Clock::time_point when) {
+        if (when <= Clock::now()) {
+            push(task);
+            return;
+        }
+        delayed.push({when, task});
+    }
+
+    /// Makes every delayed task that is due at `now` ready.
+    void promote(Clock::time_point now) {
+        while (!delayed.empty() && delayed.top().first <= now) {
+            push(delayed.top().second);
+            delayed.pop();
+        }
+    }
+
+    /// Removes and returns the best-ranked due task accepted by `accept`.
+    template <typename Predicate>
+    std::optional<TaskHandle> take(Predicate accept) {
+        std::optional<TaskHandle> found;
+        while (!ready.empty()) {
+            std::pop_heap(ready.begin(), ready.end(), after);
+            if (accept(ready.back().task)) {
+                found = ready.back().task;
+                ready.pop_back();
+                break;
+            }
+            skipped.push_back(ready.back());
+            ready.pop_back();
+        }
+        for (const auto &entry : skipped) {
+            ready.push_back(entry);
+            std::push_heap(ready.begin(), ready.end(), after);
+        }
+        skipped.clear();
+        return found;
+    }
+
+    bool empty() const { return ready.empty() && delayed.empty(); }
+    bool has_delayed() const { return !delayed.empty(); }
+
+    /// Wake-up time of the earliest delayed task; requires `has_delayed()`.
+    Clock::time_point next_wake() const { return delayed.top().first; }
+
+  private:
+    struct Entry {
+        Rank rank;
+        std::uint64_t seq;
+        TaskHandle task;
+    };
+    using Delayed = std::pair<Clock::time_point, TaskHandle>;
+
+    /// Heap order: true if `a` should be served after `b`
+    static bool after(const Entry &a, const Entry &b) {
+        if (a.rank.before(b.rank))
+            return false;
+        if (b.rank.before(a.rank))
+            return true;
+        return a.seq > b.seq;
+    }
+
+    const std::vector<Rank> &ranks;
+    std::uint64_t next_seq = 0;
+    std::vector<Entry> ready;
+    std::vector<Entry> skipped;
+    std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>>
+        delayed;
+};
+
+/// Runs the body of a lifecycle phase, timing it for the installed metrics
+/// registry
+template <typename Body> void time_phase(LifecyclePhase phase, Body &&body) {
+    MetricsRegistry *metrics = MetricsRegistry::installed();
+    const std::uint64_t start = metrics ? trace_now() : 0;
+    body();
+    if (metrics)
+        metrics->record_phase(phase, trace_now() - start);
+}
+
+} // namespace
+
+template <typename Visit>
+void Lifecycle::for_each_dependent(TaskHandle task, Visit visit) const {
+    if (task + 1 < dependent_offsets.size()) {
+        for (auto e = dependent_offsets[task]; e < dependent_offsets[task + 1];
+             ++e)
+            visit(dependents[e]);
+    }
+    if (late_dependents.empty())
+        return;
+    auto it = late_dependents.find(task);
+    if (it != late_dependents.end()) {
+        for (TaskHandle dependent : it->second)
+            visit(dependent);
+    }
+}
+
+Lifecycle::Lifecycle() = default;
+
+Lifecycle::~Lifecycle() {
+    for (auto it = arena_tasks.rbegin(); it != arena_tasks.rend(); ++it)
+        (*it)->~Task();
+}
+
+TaskResult Lifecycle::execute_virtual(Task &task, Lifecycle &lifecycle) {
+    return task.execute(lifecycle);
+}
+
+TaskHandle Lifecycle::add_task(const std::string &id,
+                               std::shared_ptr<Task> task) {
+    return add_task(id, std::move(task), TaskOptions{});
+}
+
+TaskHandle Lifecycle::add_task(const std::string &id,
+                               std::shared_ptr<Task> task,
+                               TaskOptions options) {
+    return add_task(id, std::move(task), std::move(options), {});
+}
+
+TaskHandle Lifecycle::add_task(const std::string &id,
+                               std::shared_ptr<Task> task, TaskOptions options,
+                               const std::vector<TaskHandle> &prerequisites) {
+    if (!task)
+        throw std::invalid_argument("Task '" + id + "' is null.");
+    Task *object = task.get();
+    return add_node(
+        {id, std::move(task), std::move(options), object, &execute_virtual},
+        prerequisites, false);
+}
+
+TaskHandle Lifecycle::add_node(TaskNode node,
+                               const std::vector<TaskHandle> &prerequisites,
+                               bool arena) {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    if (arena)
+        arena_tasks.push_back(node.object);
+    for (TaskHandle prerequisite : prerequisites) {
+        if (prerequisite >= tasks.size())
+            throw std::invalid_argument("Unknown task handle in dependency.");
+    }
+
+    // Check a replaced task's new prerequisites before changing anything; a
+    // task that already started is refused by `insert_task()`
+    auto existing = task_ids.find(node.id);
+    const bool fresh = existing == task_ids.end();
+    if (executing && !fresh &&
+        task_state(existing->second) == TaskState::PENDING) {
+        for (TaskHandle prerequisite : prerequisites)
+            check_late_link(prerequisite, existing->second);
+    }
+    const TaskHandle handle = insert_task(std::move(node));
+    for (TaskHandle prerequisite : prerequisites)
+        link_tasks(prerequisite, handle, !fresh);
+
+    if (executing && fresh && in_degree[handle] == 0) {
+        schedule(handle);
+        graph_changed.notify_all();
+    }
+    return handle;
+}
+
+TaskHandle Lifecycle::insert_task(TaskNode node) {
+    compiled = false;
+    auto it = task_ids.find(node.id);
+    if (it != task_ids.end()) {
+        const TaskHandle handle = it->second;
+        if (executing && task_state(handle) != TaskState::PENDING)
+            throw std::logic_error("Cannot replace task '" + node.id +
+                                   "' once it started.");
+        TaskNode &existing = tasks[handle];
+        existing.task = std::move(node.task);
+        existing.options = std::move(node.options);
+        existing.object = node.object;
+        existing.execute = node.execute;
+        if (executing)
+            prepare_late_task(handle);
+        return handle;
+    }
+
+    const TaskHandle handle = static_cast<TaskHandle>(tasks.size());
+    task_ids[node.id] = handle;
+    tasks.push_back(std::move(node));
+    if (completed.size() < (tasks.size() + 63) / 64)
+        completed.emplace_back();
+    states.emplace_back();
+    if (executing)
+        prepare_late_task(handle);
+    return handle;
+}
+
+void Lifecycle::prepare_late_task(TaskHandle task) {
+    if (task >= in_degree.size()) {
+        in_degree.push_back(0);
+        task_resource.push_back(NO_RESOURCE);
+        task_async.push_back(0);
+        task_dispatch.emplace_back();
+        task_rank.emplace_back();
+        retry_state.emplace_back();
+    }
+
+    const TaskNode &node = tasks[task];
+    task_resource[task] = NO_RESOURCE;
+    if (!node.options.resource.empty()) {
+        auto [it, added] = resource_ids.emplace(
+            node.options.resource, static_cast<std::uint32_t>(resource_count));
+        if (added) {
+            ++resource_count;
+            resource_busy.push_back(0);
+        }
+        task_resource[task] = it->second;
+    }
+    task_async[task] = dynamic_cast<const AsyncTask *>(node.object) != nullptr;
+    task_dispatch[task] = {node.execute, node.object};
+
+    // Prerequisites keep their ranks until the next compilation
+    task_rank[task] = rank_of(task);
 }
 
 void Lifecycle::add_dependency(const std::string &from, const std::string &to) {
-    dependencies[from].push_back(to);
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    link_tasks(require_task(from), require_task(to), true);
+    if (executing)
+        graph_changed.notify_all();
+}
+
+void Lifecycle::add_dependency(TaskHandle from, TaskHandle to) {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    link_tasks(from, to, true);
+    if (executing)
+        graph_changed.notify_all();
+}
+
+void Lifecycle::link_tasks(TaskHandle from, TaskHandle to, bool checked) {
+    if (from >= tasks.size() || to >= tasks.size())
+        throw std::invalid_argument("Unknown task handle in dependency.");
+    if (executing && checked)
+        check_late_link(from, to);
+
+    compiled = false;
+    dependency_edges.emplace_back(from, to);
+    if (!executing)
+        return;
+    late_dependents[from].push_back(to);
+    if (!is_task_completed(from))
+        ++in_degree[to];
+}
+
+void Lifecycle::check_late_link(TaskHandle from, TaskHandle to) const {
+    if (task_state(to) != TaskState::PENDING || in_degree[to] == 0)
+        throw std::logic_error("Task '" + tasks[to].id + "' is already ready.");
+    if (from == to || reaches(to, from))
+        throw std::logic_error("Dependency '" + tasks[from].id + "' -> '" +
+                               tasks[to].id + "' would create a cycle.");
+}
+
+bool Lifecycle::reaches(TaskHandle from, TaskHandle to) const {
+    std::vector<char> seen(tasks.size(), 0);
+    std::vector<TaskHandle> stack{from};
+    seen[from] = 1;
+    while (!stack.empty()) {
+        const TaskHandle task = stack.back();
+        stack.pop_back();
+        if (task == to)
+            return true;
+        for_each_dependent(task, [&](TaskHandle next) {
+            if (!seen[next]) {
+                seen[next] = 1;
+                stack.push_back(next);
+            }
+        });
+    }
+    return false;
+}
+
+void Lifecycle::set_parallelism(std::size_t workers) {
+    parallelism = workers == 0 ? 1 : workers;
+}
+
+TaskHandle Lifecycle::require_task(const std::string &id) const {
+    auto it = task_ids.find(id);
+    if (it == task_ids.end())
+        throw std::invalid_argument("Unknown task: " + id);
+    return it->second;
+}
+
+std::optional<TaskHandle> Lifecycle::task_handle(const std::string &id) const {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    auto it = task_ids.find(id);
+    if (it != task_ids.end())
+        return it->second;
+    return std::nullopt;
+}
+
+const std::string &Lifecycle::task_id(TaskHandle task) const {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    return tasks.at(task).id;
+}
+
+std::size_t Lifecycle::task_count() const { return states.size(); }
+
+const TaskOptions &Lifecycle::task_options(TaskHandle task) const {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    return tasks.at(task).options;
+}
+
+std::vector<TaskHandle> Lifecycle::predicted_tasks(std::size_t limit) const {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    std::vector<TaskHandle> predicted;
+    if (!executing)
+        return predicted;
+
+    // Count, per task, the prerequisites that are running right now
+    std::vector<std::uint32_t> running(tasks.size(), 0);
+    for (TaskHandle t = 0; t < tasks.size(); ++t) {
+        if (task_state(t) == TaskState::RUNNING)
+            for_each_dependent(t, [&](TaskHandle next) { ++running[next]; });
+    }
+    for (TaskHandle t = 0; t < tasks.size(); ++t) {
+        const TaskState state = task_state(t);
+        if (state == TaskState::RETRYING ||
+            (state == TaskState::PENDING && in_degree[t] == running[t]))
+            predicted.push_back(t);
+    }
+
+    auto cut = predicted.begin() + std::min(limit, predicted.size());
+    std::partial_sort(predicted.begin(), cut, predicted.end(),
+                      [&](TaskHandle a, TaskHandle b) {
+                          return task_rank[a].before(task_rank[b]);
+                      });
+    predicted.erase(cut, predicted.end());
+    return predicted;
+}
+
+std::vector<std::string> Lifecycle::predicted_targets(std::size_t limit) const {
+    std::vector<std::string> targets;
+    for (TaskHandle task : predicted_tasks(limit)) {
+        const std::string &target = task_options(task).target;
+        if (!target.empty() &&
+            std::find(targets.begin(), targets.end(), target) == targets.end())
+            targets.push_back(target);
+    }
+    return targets;
 }
 
 void Lifecycle::run() {
-    declare();
-    calibrate();
-    wait();
-    execute_tasks();
-    clean();
-    reset();
+    // Progress of an interrupted run, if any
+    const CheckpointState saved =
+        checkpoint ? checkpoint->state() : CheckpointState{};
+    resuming = saved.phases != 0;
+    resumed_node = saved.node;
+    struct ResumeScope {
+        Lifecycle &lifecycle;
+        ~ResumeScope() { lifecycle.resuming = false; }
+    } scope{*this};
+
+    auto phase = [&](LifecyclePhase id, [[maybe_unused]] const char *name,
+                     auto &&body) {
+        if (saved.finished(id))
+            return;
+        CHOROS_TRACE_EVENT(TraceEvent::phase_begin(name));
+        time_phase(id, body);
+        CHOROS_TRACE_EVENT(TraceEvent::phase_end(name));
+        if (checkpoint) {
+            checkpoint->record_phase(id);
+            checkpoint->sync();
+        }
+    };
+
+    // Always declared again, since the tasks only live in memory
+    CHOROS_TRACE_EVENT(TraceEvent::phase_begin("declare"));
+    time_phase(LifecyclePhase::DECLARE, [&] { declare(); });
+    CHOROS_TRACE_EVENT(TraceEvent::phase_end("declare"));
+
+    phase(LifecyclePhase::CALIBRATE, "calibrate", [&] { calibrate(); });
+    phase(LifecyclePhase::WAIT, "wait", [&] { wait(); });
+    phase(LifecyclePhase::EXECUTE_TASKS, "execute_tasks", [&] {
+        if (checkpoint) {
+            const std::uint64_t graph = graph_fingerprint();
+            if (saved.graph == graph)
+                restore_tasks(saved);
+            else
+                checkpoint->record_graph(graph);
+        }
+        execute_tasks();
+    });
+    phase(LifecyclePhase::CLEAN, "clean", [&] { clean(); });
+    phase(LifecyclePhase::RESET, "reset", [&] { reset(); });
+
+    if (checkpoint)
+        checkpoint->clear();
 }
 
-void Lifecycle::build_in_degree() {
-    in_degree.clear();
-    for (const auto &[id, _] : task_map)
-        in_degree[id] = 0;
+void Lifecycle::enable_checkpoint(const std::string &path,
+                                  std::chrono::milliseconds sync_interval) {
+    checkpoint = std::make_unique<CheckpointLog>(path, sync_interval);
+}
+
+void Lifecycle::record_node(const std::string &node) {
+    if (checkpoint)
+        checkpoint->record_node(node);
+}
+
+std::optional<std::string> Lifecycle::restored_node() const {
+    return resumed_node;
+}
 
-    for (const auto &[from, to_list] : dependencies) {
-        for (const auto &to : to_list) {
-            in_degree[to]++;
+bool Lifecycle::is_resuming() const { return resuming; }
+
+std::uint64_t Lifecycle::graph_fingerprint() const {
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    // FNV-1a over the IDs in handle order, then the dependency edges
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&](const void *data, std::size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 0x100000001b3ull;
         }
+    };
+    for (const TaskNode &node : tasks)
+        mix(node.id.c_str(), node.id.size() + 1);
+    for (const auto &[from, to] : dependency_edges) {
+        mix(&from, sizeof(from));
+        mix(&to, sizeof(to));
     }
+    return h;
 }
 
-std::vector<std::string> Lifecycle::get_ready_tasks() {
-    std::vector<std::string> ready;
-    for (const auto &[id, deg] : in_degree) {
-        if (deg == 0 && !completed.count(id))
-            ready.push_back(id);
+void Lifecycle::restore_tasks(const CheckpointState &saved) {
+    const std::size_t n = std::min(tasks.size(), saved.tasks.size());
+    for (TaskHandle t = 0; t < n; ++t) {
+        const TaskState state = saved.tasks[t];
+        if (state != TaskState::SUCCEEDED && state != TaskState::FAILED)
+            continue;
+        set_state(t, state);
+        mark_completed(t);
+    }
+    restored_attempts.assign(saved.attempts.begin(),
+                             saved.attempts.begin() + n);
+}
+
+void Lifecycle::compile_tasks() {
+    // Recompiling would renumber resources and clear the late dependents the
+    // running executor relies on
+    std::lock_guard<std::mutex> lock(graph_mutex);
+    if (executing)
+        throw std::logic_error("Cannot compile tasks during execute_tasks().");
+    const std::size_t n = tasks.size();
+
+    // Counting sort of the edges by source into CSR form
+    dependent_offsets.assign(n + 1, 0);
+    for (const auto &[from, to] : dependency_edges)
+        ++dependent_offsets[from + 1];
+    for (std::size_t i = 0; i < n; ++i)
+        dependent_offsets[i + 1] += dependent_offsets[i];
+    dependents.resize(dependency_edges.size());
+    std::vector<std::uint32_t> cursor(dependent_offsets.begin(),
+                                      dependent_offsets.end() - 1);
+    for (const auto &[from, to] : dependency_edges)
+        dependents[cursor[from]++] = to;
+
+    // Kahn's algorithm; tasks left over afterwards lie on a cycle
+    std::vector<std::uint32_t> remaining(n, 0);
+    for (TaskHandle to : dependents)
+        ++remaining[to];
+    std::vector<TaskHandle> order;
+    order.reserve(n);
+    for (TaskHandle t = 0; t < n; ++t) {
+        if (remaining[t] == 0)
+            order.push_back(t);
+    }
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const TaskHandle t = order[i];
+        for (auto e = dependent_offsets[t]; e < dependent_offsets[t + 1]; ++e) {
+            if (--remaining[dependents[e]] == 0)
+                order.push_back(dependents[e]);
+        }
+    }
+    if (order.size() != n) {
+        auto stuck = std::find_if(remaining.begin(), remaining.end(),
+                                  [](std::uint32_t deg) { return deg > 0; });
+        throw std::logic_error("Task graph contains a cycle through '" +
+                               tasks[stuck - remaining.begin()].id + "'.");
+    }
+
+    // Intern resources so the executor only compares integers
+    resource_ids.clear();
+    late_dependents.clear();
+    task_resource.assign(n, NO_RESOURCE);
+    for (TaskHandle t = 0; t < n; ++t) {
+        const std::string &resource = tasks[t].options.resource;
+        if (resource.empty())
+            continue;
+        auto [it, _] = resource_ids.emplace(
+            resource, static_cast<std::uint32_t>(resource_ids.size()));
+        task_resource[t] = it->second;
+    }
+    resource_count = resource_ids.size();
+
+    task_async.assign(n, 0);
+    task_dispatch.resize(n);
+    for (TaskHandle t = 0; t < n; ++t) {
+        const TaskNode &node = tasks[t];
+        task_async[t] = dynamic_cast<const AsyncTask *>(node.object) != nullptr;
+        task_dispatch[t] = {node.execute, node.object};
+    }
+
+    compute_ranks(order);
+    compiled = true;
+}
+
+bool Lifecycle::TaskRank::before(const TaskRank &other) const {
+    if (priority != other.priority)
+        return priority > other.priority;
+    if (latest_start != other.latest_start)
+        return latest_start < other.latest_start;
+    return critical_path > other.critical_path;
+}
+
+void Lifecycle::compute_ranks(const std::vector<TaskHandle> &order) {
+    // Walk backwards so every dependent is ranked before its prerequisites
+    task_rank.assign(tasks.size(), TaskRank{});
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+        task_rank[*it] = rank_of(*it);
+}
+
+Lifecycle::TaskRank Lifecycle::rank_of(TaskHandle task) const {
+    using std::chrono::milliseconds;
+
+    const TaskOptions &options = tasks[task].options;
+    TaskRank rank;
+    rank.priority = options.priority;
+
+    milliseconds downstream{0};
+    milliseconds latest_finish = milliseconds::max();
+    if (options.deadline.has_value())
+        latest_finish = options.deadline.value();
+    for_each_dependent(task, [&](TaskHandle dependent) {
+        const TaskRank &next = task_rank[dependent];
+        downstream = std::max(downstream, next.critical_path);
+        latest_finish = std::min(latest_finish, next.latest_start);
+    });
+
+    rank.critical_path = options.expected_duration + downstream;
+    rank.latest_start = latest_finish == milliseconds::max()
+                            ? latest_finish
+                            : latest_finish - options.expected_duration;
+    return rank;
+}
+
+void Lifecycle::mark_completed(TaskHandle task) {
+    completed[task / 64].fetch_or(std::uint64_t{1} << (task % 64),
+                                  std::memory_order_release);
+    epoch.fetch_add(1, std::memory_order_release);
+}
+
+void Lifecycle::set_state(TaskHandle task, TaskState state) {
+    states[task].store(state, std::memory_order_release);
+}
+
+void Lifecycle::build_in_degree() {
+    in_degree.assign(tasks.size(), 0);
+    for (TaskHandle t = 0; t < tasks.size(); ++t) {
+        if (is_task_completed(t))
+            continue;
+        for (auto e = dependent_offsets[t]; e < dependent_offsets[t + 1]; ++e)
+            ++in_degree[dependents[e]];
+    }
+}
+
+std::vector<TaskHandle> Lifecycle::get_ready_tasks() const {
+    std::vector<TaskHandle> ready;
+    for (TaskHandle t = 0; t < tasks.size(); ++t) {
+        if (in_degree[t] == 0 && !is_task_completed(t))
+            ready.push_back(t);
     }
     return ready;
 }
 
 void Lifecycle::execute_tasks() {
+    if (!compiled)
+        compile_tasks();
     build_in_degree();
-    std::queue<std::string> queue;
+    retry_state.assign(tasks.size(), RetryState{});
+    for (TaskHandle t = 0; t < restored_attempts.size(); ++t) {
+        if (restored_attempts[t] == 0)
+            continue;
+        retry_state[t].attempts = restored_attempts[t];
+        retry_state[t].first_attempt = Clock::now();
+    }
+    restored_attempts.clear();
+    for (TaskHandle t = 0; t < tasks.size(); ++t) {
+        if (!is_task_completed(t))
+            set_state(t, TaskState::PENDING);
+    }
+    resource_busy.assign(resource_count, 0);
 
-    for (const auto &id : get_ready_tasks()) {
-        queue.push(id);
+    // Tasks inserted from here on are linked in place (see `link_tasks()`)
+    struct RunScope {
+        Lifecycle &lifecycle;
+        ~RunScope() {
+            lifecycle.executing = false;
+            lifecycle.schedule = nullptr;
+        }
+    } scope{*this};
+    executing = true;
+    if (parallelism > 1)
+        execute_parallel();
+    else
+        execute_serial();
+}
+
+void Lifecycle::begin_attempt(TaskHandle task) {
+    RetryState &state = retry_state[task];
+    if (state.attempts++ == 0)
+        state.first_attempt = Clock::now();
+    set_state(task, TaskState::RUNNING);
+    if (checkpoint)
+        checkpoint->record_attempt(
+            task, static_cast<std::uint32_t>(state.attempts));
+    CHOROS_TRACE_EVENT(TraceEvent::task_dispatch(
+        tasks[task].id.c_str(), static_cast<std::uint32_t>(state.attempts)));
+    if (auto *metrics = MetricsRegistry::installed())
+        metrics->record_task_attempt(
+            tasks[task].id, static_cast<std::uint32_t>(state.attempts));
+}
+
+bool Lifecycle::finish_attempt(TaskHandle task, TaskResult result,
+                               std::vector<TaskHandle> &unlocked,
+                               Clock::time_point &retry_at) {
+    CHOROS_TRACE_EVENT(TraceEvent::task_result(
+        tasks[task].id.c_str(), static_cast<int>(result),
+        static_cast<std::uint32_t>(retry_state[task].attempts)));
+
+    if (result == TaskResult::RETRYABLE_FAILURE) {
+        const RetryPolicy &policy = tasks[task].options.retry;
+        RetryState &state = retry_state[task];
+        const auto now = Clock::now();
+
+        using std::chrono::milliseconds;
+        state.backoff =
+            state.attempts == 1
+                ? policy.initial_backoff
+                : std::min(policy.max_backoff,
+                           std::chrono::duration_cast<milliseconds>(
+                               state.backoff * policy.backoff_multiplier));
+        retry_at = now + state.backoff;
+
+        bool attempts_left =
+            policy.max_attempts == 0 || state.attempts < policy.max_attempts;
+        bool before_deadline =
+            policy.deadline.count() == 0 ||
+            retry_at <= state.first_attempt + policy.deadline;
+        if (attempts_left && before_deadline) {
+            set_state(task, TaskState::RETRYING);
+            return true;
+        }
+        // Out of retries: settle the task as a fatal failure
     }
 
-    while (!queue.empty()) {
-        std::string current = queue.front();
-        queue.pop();
+    const TaskState settled = result == TaskResult::SUCCESS
+                                  ? TaskState::SUCCEEDED
+                                  : TaskState::FAILED;
+    set_state(task, settled);
+    mark_completed(task);
+    if (checkpoint)
+        checkpoint->record_task(task, settled);
+    for_each_dependent(task, [&](TaskHandle dependent) {
+        if (--in_degree[dependent] == 0)
+            unlocked.push_back(dependent);
+    });
+    return false;
+}
 
-        auto &task = task_map.at(current);
-        TaskResult result = task->execute(*this);
+void Lifecycle::execute_serial() {
+    ReadyQueue<TaskRank> queue(task_rank);
+    for (TaskHandle task : get_ready_tasks())
+        queue.push(task);
 
-        if (result == TaskResult::SUCCESS ||
-            result == TaskResult::FATAL_FAILURE) {
-            completed.insert(current);
-            for (const auto &dependent : dependencies[current]) {
-                if (--in_degree[dependent] == 0)
-                    queue.push(dependent);
+    // Async tasks suspended mid-attempt; they hold their resource meanwhile
+    struct Suspended {
+        TaskHandle task;
+        TaskCoroutine routine;
+    };
+    std::vector<Suspended> suspended;
+    schedule = [&](TaskHandle task) { queue.push(task); };
+    auto resource_free = [&](TaskHandle task) {
+        return task_resource[task] == NO_RESOURCE ||
+               !resource_busy[task_resource[task]];
+    };
+    auto set_busy = [&](TaskHandle task, char busy) {
+        if (task_resource[task] != NO_RESOURCE)
+            resource_busy[task_resource[task]] = busy;
+    };
+
+    std::vector<TaskHandle> unlocked;
+    auto settle = [&](TaskHandle task, TaskResult result) {
+        unlocked.clear();
+        Clock::time_point retry_at;
+        if (finish_attempt(task, result, unlocked, retry_at))
+            queue.push_at(task, retry_at); // requeue for retry
+        for (TaskHandle dependent : unlocked)
+            queue.push(dependent);
+    };
+
+    while (!queue.empty() || !suspended.empty()) {
+        const auto now = Clock::now();
+        queue.promote(now);
+
+        // Resume every suspended task whose timer or condition fired
+        for (std::size_t i = 0; i < suspended.size();) {
+            TaskCoroutine &routine = suspended[i].routine;
+            if (!routine.ready(now)) {
+                ++i;
+                continue;
             }
+            routine.resume();
+            if (!routine.done()) {
+                ++i;
+                continue;
+            }
+            const TaskHandle task = suspended[i].task;
+            const TaskResult result = routine.result();
+            suspended[i] = std::move(suspended.back());
+            suspended.pop_back();
+            set_busy(task, 0);
+            settle(task, result);
+        }
+
+        auto current = queue.take(resource_free);
+        if (!current.has_value()) {
+            // Nothing to run; sleep until a retry or a suspended task is due
+            auto wake = Clock::time_point::max();
+            if (queue.has_delayed())
+                wake = queue.next_wake();
+            for (const Suspended &entry : suspended)
+                wake = std::min(wake, entry.routine.wake_at());
+            if (wake != Clock::time_point::max())
+                std::this_thread::sleep_until(wake);
+            continue;
         }
 
-        if (result == TaskResult::RETRYABLE_FAILURE) {
-            queue.push(current); // requeue for retry
+        const TaskHandle task = current.value();
+        begin_attempt(task);
+        const TaskDispatch dispatch = task_dispatch[task];
+        if (!task_async[task]) {
+            settle(task, dispatch.execute(*dispatch.object, *this));
+            continue;
         }
+
+        // Run the coroutine up to its first suspension
+        auto &async = static_cast<AsyncTask &>(*dispatch.object);
+        TaskCoroutine routine = async.run(*this);
+        routine.resume();
+        if (routine.done()) {
+            settle(task, routine.result());
+            continue;
+        }
+        set_busy(task, 1);
+        suspended.push_back({task, std::move(routine)});
     }
 }
 
-bool Lifecycle::is_task_completed(const std::string &id) {
-    return completed.count(id);
+void Lifecycle::execute_parallel() {
+    ReadyQueue<TaskRank> queue(task_rank);
+    std::size_t running = 0;
+    std::exception_ptr error;
+
+    for (TaskHandle task : get_ready_tasks())
+        queue.push(task);
+    // Called by inserting tasks, which hold `graph_mutex`
+    schedule = [&](TaskHandle task) { queue.push(task); };
+
+    auto resource_free = [&](TaskHandle task) {
+        return task_resource[task] == NO_RESOURCE ||
+               !resource_busy[task_resource[task]];
+    };
+
+    auto worker = [&]() {
+        std::vector<TaskHandle> unlocked;
+        std::unique_lock<std::mutex> lock(graph_mutex);
+        while (true) {
+            if (error || (queue.empty() && running == 0))
+                break;
+
+            // Take the best-ranked due task whose resource is free
+            queue.promote(Clock::now());
+            auto next = queue.take(resource_free);
+            if (!next.has_value()) {
+                if (queue.has_delayed())
+                    graph_changed.wait_until(lock, queue.next_wake());
+                else
+                    graph_changed.wait(lock);
+                continue;
+            }
+
+            const TaskHandle current = next.value();
+            const std::uint32_t resource = task_resource[current];
+            if (resource != NO_RESOURCE)
+                resource_busy[resource] = 1;
+            ++running;
+            begin_attempt(current);
+            const TaskDispatch dispatch = task_dispatch[current];
+            lock.unlock();
+
+            TaskResult result = TaskResult::FATAL_FAILURE;
+            std::exception_ptr failure;
+            try {
+                result = dispatch.execute(*dispatch.object, *this);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            lock.lock();
+            --running;
+            if (resource != NO_RESOURCE)
+                resource_busy[resource] = 0;
+
+            if (failure) {
+                if (!error)
+                    error = failure;
+            } else {
+                unlocked.clear();
+                Clock::time_point retry_at;
+                if (finish_attempt(current, result, unlocked, retry_at))
+                    queue.push_at(current, retry_at); // requeue for retry
+                for (TaskHandle dependent : unlocked)
+                    queue.push(dependent);
+            }
+            graph_changed.notify_all();
+        }
+        graph_changed.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(parallelism);
+    for (std::size_t i = 0; i < parallelism; ++i)
+        workers.emplace_back(worker);
+    for (auto &thread : workers)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+bool Lifecycle::is_task_completed(const std::string &id) const {
+    auto handle = task_handle(id);
+    return handle.has_value() && is_task_completed(handle.value());
+}
+
+bool Lifecycle::is_task_completed(TaskHandle task) const {
+    return task < states.size() &&
+           (completed[task / 64].load(std::memory_order_acquire) >>
+            (task % 64)) &
+               std::uint64_t{1};
+}
+
+TaskState Lifecycle::task_state(TaskHandle task) const {
+    if (task >= states.size())
+        throw std::out_of_range("Unknown task handle.");
+    return states[task].load(std::memory_order_acquire);
+}
+
+ProgressSnapshot Lifecycle::progress() const {
+    // Reading the epoch first makes every completion it counts visible
+    ProgressSnapshot snapshot;
+    snapshot.epoch = epoch.load(std::memory_order_acquire);
+    const std::size_t words = completed.size();
+    snapshot.completed.reserve(words);
+    for (std::size_t i = 0; i < words; ++i)
+        snapshot.completed.push_back(
+            completed[i].load(std::memory_order_acquire));
+    return snapshot;
+}
+
+std::uint64_t Lifecycle::progress_epoch() const {
+    return epoch.load(std::memory_order_acquire);
 }
 
 } // namespace choros
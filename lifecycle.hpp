@@ -1,14 +1,129 @@
 #pragma once
 
+#include "growable_array.hpp"
 #include "task.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace choros {
 
+/// Dense identifier of a task within its `Lifecycle`, assigned by `add_task()`.
+using TaskHandle = std::uint32_t;
+
+/**
+ * @brief Controls how a task returning `RETRYABLE_FAILURE` is retried.
+ *
+ * The first retry waits `initial_backoff`; each further retry multiplies the
+ * wait by `backoff_multiplier`, capped at `max_backoff`. While a task waits,
+ * other ready tasks run and an idle scheduler sleeps instead of spinning.
+ * A task that runs out of attempts, or whose next retry would start after
+ * `deadline` has elapsed since its first attempt, is settled as a
+ * `FATAL_FAILURE`.
+ *
+ * The default policy retries forever, waiting 10 ms before the first retry
+ * and up to a second between later ones, so a task that keeps failing never
+ * busy-loops. Set `initial_backoff` to 0 to retry immediately.
+ */
+struct RetryPolicy {
+    /// Maximum number of attempts, including the first; 0 means unlimited
+    std::size_t max_attempts = 0;
+    /// Wait before the first retry
+    std::chrono::milliseconds initial_backoff{10};
+    /// Factor applied to the wait after each further retry
+    double backoff_multiplier = 2.0;
+    /// Upper bound on the wait between two attempts
+    std::chrono::milliseconds max_backoff{1000};
+    /// Time since the first attempt after which no retry starts; 0 disables
+    std::chrono::milliseconds deadline{0};
+};
+
+/**
+ * @brief Per-task scheduling options.
+ */
+struct TaskOptions {
+    /// Name of the actuator or mechanism this task drives. Tasks sharing a
+    /// non-empty resource never run at the same time, even with parallel
+    /// execution enabled.
+    std::string resource;
+
+    /// How retryable failures of this task are retried
+    RetryPolicy retry;
+
+    /// Higher-priority ready tasks are dispatched first
+    int priority = 0;
+
+    /// Estimated run time, used to compute critical paths and slack
+    std::chrono::milliseconds expected_duration{0};
+
+    /// Time, measured from the start of `execute_tasks()`, by which the task
+    /// should have finished
+    std::optional<std::chrono::milliseconds> deadline;
+
+    /// Field node the task drives to, if any; used to predict upcoming
+    /// routes (see `Lifecycle::predicted_tasks()`)
+    std::string target;
+};
+
+/**
+ * @brief Execution state of a task, readable from any thread.
+ */
+enum class TaskState : std::uint8_t {
+    PENDING,   ///< Not attempted yet in this run
+    RUNNING,   ///< An attempt is executing (or suspended, for `AsyncTask`s)
+    RETRYING,  ///< Waiting out a retry backoff
+    SUCCEEDED, ///< Settled with `SUCCESS`
+    FAILED     ///< Settled with `FATAL_FAILURE` or out of retries
+};
+
+/**
+ * @brief Phases of `Lifecycle::run()`, in order.
+ */
+enum class LifecyclePhase : std::uint8_t {
+    DECLARE,
+    CALIBRATE,
+    WAIT,
+    EXECUTE_TASKS,
+    CLEAN,
+    RESET
+};
+
+/**
+ * @brief Completion progress of a lifecycle, from `Lifecycle::progress()`.
+ *
+ * `completed` is a bitset indexed by task handle. `epoch` counts the
+ * completions the snapshot is guaranteed to contain; as the snapshot is taken
+ * without locking, a completion racing with it may show up in the bitset
+ * before it is counted, never the other way round.
+ */
+struct ProgressSnapshot {
+    std::uint64_t epoch = 0;
+    std::vector<std::uint64_t> completed;
+
+    /// Returns true if `task` is marked as completed in this snapshot.
+    bool is_completed(TaskHandle task) const {
+        return task / 64 < completed.size() &&
+               (completed[task / 64] >> (task % 64)) & std::uint64_t{1};
+    }
+};
+
+class CheckpointLog;
+struct CheckpointState;
+
 /**
  * @brief Abstract base class representing the high-level lifecycle of a robot
  * run.
@@ -29,32 +144,130 @@ namespace choros {
  * may depend on the successful completion of others. Dependency resolution is
  * handled internally using a BFS-based topological sorting algorithm.
  *
+ * Each task is identified by a dense `TaskHandle` returned from `add_task()`.
+ * Before the first execution the graph is compiled into contiguous arrays (a
+ * CSR list of dependents, in-degrees and a completion bitset); string IDs are
+ * only used for lookup and logging.
+ *
+ * Completion and task state live in atomics, so other threads (e.g. a
+ * heartbeat broadcasting progress) may call `is_task_completed()`,
+ * `task_state()`, `progress()` and `progress_epoch()` while tasks execute,
+ * without locking, even while tasks are being added.
+ *
+ * Tasks may add further tasks and dependencies while `execute_tasks()` runs
+ * (see `add_task()` and `add_dependency()`); in-degrees are updated in place
+ * and new tasks whose prerequisites are met are dispatched right away.
+ *
  * Subclasses must implement all physical lifecycle phases.
  */
 class Lifecycle {
   public:
+    Lifecycle();
+
     /// Virtual destructor
-    virtual ~Lifecycle() = default;
+    virtual ~Lifecycle();
 
     /**
      * @brief Adds a task to the lifecycle's internal task graph.
      *
+     * Adding a task under an existing ID replaces it and keeps its handle.
+     *
+     * May be called by executing tasks: a new task is then ready at once
+     * (use the overload taking prerequisites to add it with dependencies).
+     * Replacing a task that is no longer pending during a run throws
+     * `std::logic_error`. A null `task` throws `std::invalid_argument`.
+     *
+     * @param id A unique string identifier for the task.
+     * @param task A shared pointer to the task instance.
+     * @return The task's handle.
+     */
+    TaskHandle add_task(const std::string &id, std::shared_ptr<Task> task);
+
+    /**
+     * @brief Adds a task with scheduling options.
+     *
      * @param id A unique string identifier for the task.
      * @param task A shared pointer to the task instance.
+     * @param options Scheduling options such as the task's resource.
+     * @return The task's handle.
+     */
+    TaskHandle add_task(const std::string &id, std::shared_ptr<Task> task,
+                        TaskOptions options);
+
+    /**
+     * @brief Adds a task together with its prerequisites.
+     *
+     * During a run the task is inserted and linked in one step, so it only
+     * becomes ready once all `prerequisites` have completed; it is
+     * dispatched immediately if they already have. Throws
+     * `std::invalid_argument` for an unknown prerequisite.
+     *
+     * @param id A unique string identifier for the task.
+     * @param task A shared pointer to the task instance.
+     * @param options Scheduling options such as the task's resource.
+     * @param prerequisites Tasks the new task depends on.
+     * @return The task's handle.
+     */
+    TaskHandle add_task(const std::string &id, std::shared_ptr<Task> task,
+                        TaskOptions options,
+                        const std::vector<TaskHandle> &prerequisites);
+
+    /**
+     * @brief Constructs a task of type `T` in the lifecycle's task arena.
+     *
+     * For data-driven runs with many small tasks: the task is constructed
+     * from `args` in a monotonic arena owned by the lifecycle, next to the
+     * other emplaced tasks, and destroyed with it. It is dispatched through
+     * a function pointer calling `T::execute()` directly, without a
+     * virtual call or reference counting. Replacing it keeps its storage
+     * until destruction. Otherwise behaves like `add_task()`, and may also
+     * be called by executing tasks.
+     *
+     * @tparam T A class derived from `Task`
+     * @param id A unique string identifier for the task.
+     * @param options Scheduling options such as the task's resource.
+     * @param args Arguments for the constructor of `T`.
+     * @return The task's handle.
      */
-    void add_task(const std::string &id, std::shared_ptr<Task> task);
+    template <typename T, typename... Args>
+    TaskHandle emplace_task(const std::string &id, TaskOptions options,
+                            Args &&...args);
 
     /**
      * @brief Defines a dependency between two tasks.
      *
      * Specifies that `to` depends on `from` — i.e., `to` cannot execute
-     * until `from` has completed successfully.
+     * until `from` has completed successfully. Throws
+     * `std::invalid_argument` if either task has not been added.
+     *
+     * During a run, `to` must still be waiting on a prerequisite, and the
+     * dependency must not close a cycle; otherwise `std::logic_error` is
+     * thrown. New dependencies of a finished `from` are already met.
      *
      * @param from The ID of the prerequisite task.
      * @param to The ID of the dependent task.
      */
     void add_dependency(const std::string &from, const std::string &to);
 
+    /**
+     * @brief Defines a dependency between two tasks by handle.
+     *
+     * @param from The handle of the prerequisite task.
+     * @param to The handle of the dependent task.
+     */
+    void add_dependency(TaskHandle from, TaskHandle to);
+
+    /**
+     * @brief Compiles the task graph into its indexed form.
+     *
+     * Called automatically by `execute_tasks()` whenever tasks or
+     * dependencies changed since the last compilation. Throws
+     * `std::logic_error` if the dependencies contain a cycle, or if called
+     * while `execute_tasks()` runs (tasks added during a run are linked in
+     * place instead).
+     */
+    void compile_tasks();
+
     /**
      * @brief Executes the full lifecycle sequence.
      *
@@ -65,16 +278,136 @@ class Lifecycle {
      * - execute_tasks()
      * - clean()
      * - reset()
+     *
+     * With a checkpoint enabled, resumes an interrupted run: `declare()`
+     * runs again to rebuild the tasks, finished phases are skipped, and if
+     * the tasks match the checkpointed ones, settled tasks are not run again
+     * and retry counts carry over. The checkpoint is cleared once the run
+     * completes.
      */
     void run();
 
+    /**
+     * @brief Checkpoints the progress of `run()` to a file, so that it can
+     * resume after a crash or restart.
+     *
+     * Phases, settled tasks, attempt counts and the node from
+     * `record_node()` are appended to a log (see `CheckpointLog`) that is
+     * synced in the background every `sync_interval`. Phase ends are
+     * synced at once. A crash thus repeats at most the tasks settled within
+     * the last interval. Tasks inserted while executing are not recreated
+     * on resume. An existing log is loaded for the next `run()`.
+     *
+     * @param path Log file, created if missing
+     * @param sync_interval Time between two background syncs
+     */
+    void enable_checkpoint(const std::string &path,
+                           std::chrono::milliseconds sync_interval =
+                               std::chrono::milliseconds(20));
+
+    /**
+     * @brief Records the robot's node (e.g. `Navigation::get_node()`) in the
+     * checkpoint. Does nothing without a checkpoint.
+     */
+    void record_node(const std::string &node);
+
+    /**
+     * @brief Returns the node last recorded before the interrupted run, so
+     * that `declare()` can restore it with `Navigation::set_node()`.
+     */
+    std::optional<std::string> restored_node() const;
+
+    /**
+     * @brief Returns true while `run()` resumes an interrupted run.
+     */
+    bool is_resuming() const;
+
     /**
      * @brief Returns true if a task was completed successfully
      *
      * @param id The ID of the task
      * @return true if the task was completed successfully; false otherwise.
      */
-    bool is_task_completed(const std::string &id);
+    bool is_task_completed(const std::string &id) const;
+
+    /**
+     * @brief Returns true if a task was completed successfully
+     *
+     * @param task The handle of the task
+     */
+    bool is_task_completed(TaskHandle task) const;
+
+    /**
+     * @brief Returns the execution state of a task in the current or last
+     * run.
+     *
+     * @param task The handle of the task
+     */
+    TaskState task_state(TaskHandle task) const;
+
+    /**
+     * @brief Takes a wait-free snapshot of the completion bitset.
+     */
+    ProgressSnapshot progress() const;
+
+    /**
+     * @brief Returns the number of completions so far; pollers can skip
+     * `progress()` while it is unchanged.
+     */
+    std::uint64_t progress_epoch() const;
+
+    /**
+     * @brief Returns the handle of a task if known.
+     */
+    std::optional<TaskHandle> task_handle(const std::string &id) const;
+
+    /**
+     * @brief Returns the string ID of a task.
+     */
+    const std::string &task_id(TaskHandle task) const;
+
+    /**
+     * @brief Returns the number of tasks in the graph.
+     */
+    std::size_t task_count() const;
+
+    /**
+     * @brief Returns the scheduling options of a task.
+     */
+    const TaskOptions &task_options(TaskHandle task) const;
+
+    /**
+     * @brief Predicts which tasks run next during `execute_tasks()`.
+     *
+     * Returns the tasks that are ready or retrying, and those waiting only
+     * on running tasks, best-ranked first and at most `limit` of them. A
+     * running task can use it, together with `TaskOptions::target`, to let
+     * `Navigation::prefetch()` plan the next routes while it still drives.
+     * Returns nothing outside a run. In serial mode, call it from a task.
+     *
+     * @param limit Maximum number of tasks to return.
+     */
+    std::vector<TaskHandle> predicted_tasks(std::size_t limit = 4) const;
+
+    /**
+     * @brief Returns the distinct non-empty targets of `predicted_tasks()`.
+     */
+    std::vector<std::string> predicted_targets(std::size_t limit = 4) const;
+
+    /**
+     * @brief Sets how many tasks may execute concurrently.
+     *
+     * With a value above 1, `execute_tasks()` runs on a fixed pool of that
+     * many worker threads and dispatches every ready task whose resource is
+     * free, unlocking dependents as tasks finish. Tasks then run
+     * concurrently and must synchronize any state they share, and each
+     * `AsyncTask` blocks its worker while suspended. The default of 1
+     * executes tasks on the calling thread, interleaving suspended
+     * `AsyncTask`s in a single-threaded event loop.
+     *
+     * @param workers Maximum number of concurrently executing tasks.
+     */
+    void set_parallelism(std::size_t workers);
 
   protected:
     /**
@@ -118,36 +451,288 @@ class Lifecycle {
      * BFS-based DAG traversal.
      *
      * Tasks are only executed once all their prerequisite tasks have completed
-     * successfully. Retryable failures will requeue a task, while fatal
-     * failures will prevent downstream execution.
+     * successfully. Among ready tasks, higher priority, least slack and
+     * longest critical path go first (see `TaskOptions`). Retryable failures
+     * will requeue a task according to its `RetryPolicy`, while fatal
+     * failures will prevent downstream execution. See `set_parallelism()`
+     * for concurrent execution.
      */
     void execute_tasks();
 
   private:
-    /// Maps task IDs to their associated task instances
-    std::unordered_map<std::string, std::shared_ptr<Task>> task_map;
+    /// Calls `execute()` on a task, virtually or on its known type
+    using ExecuteFn = TaskResult (*)(Task &, Lifecycle &);
+
+    /// A task together with its identity and options
+    struct TaskNode {
+        std::string id;
+        std::shared_ptr<Task> task; ///< Null for tasks in the arena
+        TaskOptions options;
+        Task *object = nullptr;
+        ExecuteFn execute = nullptr;
+    };
+
+    /// Dispatch entry of a task in `task_dispatch`
+    struct TaskDispatch {
+        ExecuteFn execute;
+        Task *object;
+    };
+
+    static TaskResult execute_virtual(Task &task, Lifecycle &lifecycle);
+
+    template <typename T>
+    static TaskResult execute_direct(Task &task, Lifecycle &lifecycle) {
+        return static_cast<T &>(task).T::execute(lifecycle);
+    }
+
+    /**
+     * @brief Static scheduling rank of a task, derived from the DAG.
+     *
+     * Ready tasks are ordered by priority, then by latest start time (the
+     * tightest deadline downstream minus the expected durations on the way;
+     * ordering by it is equivalent to ordering by slack), then by critical
+     * path length (expected duration of the longest chain of dependents).
+     */
+    struct TaskRank {
+        int priority = 0;
+        std::chrono::milliseconds latest_start =
+            std::chrono::milliseconds::max();
+        std::chrono::milliseconds critical_path{0};
+
+        bool before(const TaskRank &other) const;
+    };
+
+    using Clock = std::chrono::steady_clock;
 
-    /// Adjacency list representing dependency edges (from ➜ to)
-    std::unordered_map<std::string, std::vector<std::string>> dependencies;
+    /// Attempt bookkeeping for retry policies
+    struct RetryState {
+        std::size_t attempts = 0;
+        Clock::time_point first_attempt;
+        std::chrono::milliseconds backoff{0};
+    };
+
+    /// Marker for tasks without a resource
+    static constexpr std::uint32_t NO_RESOURCE =
+        std::numeric_limits<std::uint32_t>::max();
+
+    /// Tasks indexed by handle; a deque so that references to a task (and
+    /// its ID, which trace events point at) survive later insertions
+    std::deque<TaskNode> tasks;
+
+    /// Maps task IDs to their handles
+    std::unordered_map<std::string, TaskHandle> task_ids;
+
+    /// Declared dependency edges (from ➜ to)
+    std::vector<std::pair<TaskHandle, TaskHandle>> dependency_edges;
+
+    /// Completion bitset indexed by handle
+    GrowableArray<std::atomic<std::uint64_t>> completed;
+
+    /// Number of completions, published after the completion bit
+    std::atomic<std::uint64_t> epoch{0};
+
+    /// Execution state indexed by handle; grown after `completed`, so its
+    /// size bounds the handles readers may look up
+    GrowableArray<std::atomic<TaskState>> states;
+
+    /// Serializes graph changes with ID lookups and, with parallelism above
+    /// 1, with the executor
+    mutable std::mutex graph_mutex;
+    std::condition_variable graph_changed;
+
+    /// Whether `execute_tasks()` is running, and how it takes newly ready
+    /// tasks
+    bool executing = false;
+    std::function<void(TaskHandle)> schedule;
+
+    /// Whether the arrays below reflect the current tasks and dependencies
+    bool compiled = false;
+
+    /// CSR adjacency: dependents of task `t` are
+    /// `dependents[dependent_offsets[t] .. dependent_offsets[t + 1])`
+    std::vector<std::uint32_t> dependent_offsets;
+    std::vector<TaskHandle> dependents;
+
+    /// Dependents added during a run, folded into the CSR arrays by the
+    /// next compilation
+    std::unordered_map<TaskHandle, std::vector<TaskHandle>> late_dependents;
 
     /// Tracks how many unresolved prerequisites each task has
-    std::unordered_map<std::string, int> in_degree;
+    std::vector<std::uint32_t> in_degree;
+
+    /// Interned resource of each task, or `NO_RESOURCE`
+    std::vector<std::uint32_t> task_resource;
+    std::unordered_map<std::string, std::uint32_t> resource_ids;
+    std::size_t resource_count = 0;
+
+    /// Whether each resource is held by a running task
+    std::vector<char> resource_busy;
+
+    /// Whether each task is an `AsyncTask`, driven by the event loop
+    std::vector<char> task_async;
+
+    /// How the executors invoke each task, contiguous by handle
+    std::vector<TaskDispatch> task_dispatch;
+
+    /// Storage of the tasks created by `emplace_task()`, which are
+    /// destroyed in reverse order with the lifecycle
+    std::pmr::monotonic_buffer_resource task_arena;
+    std::vector<Task *> arena_tasks;
+
+    std::vector<TaskRank> task_rank;
+    std::vector<RetryState> retry_state;
+
+    /// Maximum number of concurrently executing tasks
+    std::size_t parallelism = 1;
+
+    /// Progress log of `run()`, and what it restored
+    std::unique_ptr<CheckpointLog> checkpoint;
+    bool resuming = false;
+    std::optional<std::string> resumed_node;
+    std::vector<std::uint32_t> restored_attempts;
+
+    /**
+     * @brief Looks up a task handle, throwing if the ID is unknown.
+     */
+    TaskHandle require_task(const std::string &id) const;
+
+    /**
+     * @brief Adds or replaces a task; requires `graph_mutex`.
+     *
+     * During a run, a new task gets its per-task arrays extended but is not
+     * scheduled yet.
+     */
+    TaskHandle insert_task(TaskNode node);
+
+    /**
+     * @brief Body of `add_task()` and `emplace_task()`; `arena` tells
+     * whether `node.object` lives in the task arena.
+     */
+    TaskHandle add_node(TaskNode node,
+                        const std::vector<TaskHandle> &prerequisites,
+                        bool arena);
+
+    /**
+     * @brief Hashes the task IDs and dependencies, to tell whether a
+     * checkpoint refers to the current tasks.
+     */
+    std::uint64_t graph_fingerprint() const;
+
+    /**
+     * @brief Marks the tasks settled in a checkpoint as completed and keeps
+     * their attempt counts for the next `execute_tasks()`.
+     */
+    void restore_tasks(const CheckpointState &saved);
+
+    /**
+     * @brief Derives the resource, async flag and rank of a task inserted
+     * or replaced during a run.
+     */
+    void prepare_late_task(TaskHandle task);
+
+    /**
+     * @brief Records a dependency; requires `graph_mutex`.
+     *
+     * During a run, updates `in_degree` of `to` in place. `checked`
+     * enforces the preconditions documented at `add_dependency()`.
+     */
+    void link_tasks(TaskHandle from, TaskHandle to, bool checked);
+
+    /**
+     * @brief Throws unless `to` may still gain prerequisite `from` during a
+     * run; requires `graph_mutex`.
+     */
+    void check_late_link(TaskHandle from, TaskHandle to) const;
+
+    /**
+     * @brief Returns true if `to` can be reached from `from` along
+     * dependents.
+     */
+    bool reaches(TaskHandle from, TaskHandle to) const;
+
+    /**
+     * @brief Calls `visit` for each dependent of `task`.
+     */
+    template <typename Visit>
+    void for_each_dependent(TaskHandle task, Visit visit) const;
 
-    /// Tracks completed task IDs
-    std::unordered_set<std::string> completed;
+    /**
+     * @brief Marks a task as completed and bumps the epoch.
+     */
+    void mark_completed(TaskHandle task);
 
     /**
-     * @brief Initializes the in-degree map based on the current dependency
-     * graph.
+     * @brief Publishes the execution state of a task.
+     */
+    void set_state(TaskHandle task, TaskState state);
+
+    /**
+     * @brief Initializes the in-degree array from the compiled graph,
+     * counting only prerequisites that have not completed yet.
      */
     void build_in_degree();
 
     /**
      * @brief Returns all tasks that are ready to be executed (in-degree == 0).
      *
-     * @return A vector of task IDs eligible for execution.
+     * @return A vector of task handles eligible for execution.
+     */
+    std::vector<TaskHandle> get_ready_tasks() const;
+
+    /**
+     * @brief Computes `task_rank` for every task from a topological order.
+     */
+    void compute_ranks(const std::vector<TaskHandle> &order);
+
+    /**
+     * @brief Computes the rank of one task from those of its dependents.
+     */
+    TaskRank rank_of(TaskHandle task) const;
+
+    /**
+     * @brief Records the start of an attempt at running a task.
+     */
+    void begin_attempt(TaskHandle task);
+
+    /**
+     * @brief Applies the outcome of an attempt.
+     *
+     * Either settles the task, appending newly ready dependents to
+     * `unlocked`, or, for a retry allowed by the task's policy, sets
+     * `retry_at` and returns true.
      */
-    std::vector<std::string> get_ready_tasks();
+    bool finish_attempt(TaskHandle task, TaskResult result,
+                        std::vector<TaskHandle> &unlocked,
+                        Clock::time_point &retry_at);
+
+    /**
+     * @brief Runs ready tasks on the calling thread.
+     *
+     * Plain tasks run one at a time; `AsyncTask`s are started like them and
+     * then interleaved from a single-threaded event loop while suspended.
+     */
+    void execute_serial();
+
+    /**
+     * @brief Runs ready tasks on `parallelism` worker threads.
+     */
+    void execute_parallel();
 };
 
+template <typename T, typename... Args>
+TaskHandle Lifecycle::emplace_task(const std::string &id, TaskOptions options,
+                                   Args &&...args) {
+    static_assert(std::is_base_of_v<Task, T>,
+                  "emplace_task() requires a class derived from Task");
+    void *memory;
+    {
+        std::lock_guard<std::mutex> lock(graph_mutex);
+        memory = task_arena.allocate(sizeof(T), alignof(T));
+    }
+    // Constructed unlocked, since the constructor may use the lifecycle
+    T *task = ::new (memory) T(std::forward<Args>(args)...);
+    return add_node({id, nullptr, std::move(options), task, &execute_direct<T>},
+                    {}, true);
+}
+
 } // namespace choros
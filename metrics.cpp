@@ -0,0 +1,208 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace choros {
+
+namespace {
+
+std::atomic<MetricsRegistry *> installed_registry{nullptr};
+std::atomic<std::uint64_t> next_registry_id{1};
+
+/// Adds to a counter that only the calling thread writes
+void bump(std::atomic<std::uint64_t> &counter, std::uint64_t value = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+void write_micros(std::ostream &out, double ns) { out << ns / 1000.0; }
+
+void write_json_string(std::ostream &out, const std::string &text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+constexpr const char *PHASE_NAMES[LIFECYCLE_PHASE_COUNT] = {
+    "declare", "calibrate", "wait", "execute_tasks", "clean", "reset"};
+
+} // namespace
+
+std::size_t HistogramSnapshot::bucket_of(std::uint64_t value) {
+    return std::min<std::size_t>(std::bit_width(value), BUCKETS - 1);
+}
+
+std::uint64_t HistogramSnapshot::quantile(double q) const {
+    if (count == 0)
+        return 0;
+    const auto rank = static_cast<std::uint64_t>(
+        std::clamp(q, 0.0, 1.0) * static_cast<double>(count - 1));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen > rank)
+            return upper_bound(b);
+    }
+    return upper_bound(BUCKETS - 1);
+}
+
+void MetricsSnapshot::write_json(std::ostream &out) const {
+    std::size_t highest = 0;
+    for (std::size_t b = 0; b < HistogramSnapshot::BUCKETS; ++b) {
+        if (path_latency.buckets[b])
+            highest = b;
+    }
+
+    out << "{\"path_queries\":" << path_queries
+        << ",\"paths_found\":" << paths_found
+        << ",\"nodes_expanded\":" << nodes_expanded
+        << ",\"cache_hits\":" << cache_hits << ",\"cache_hit_rate\":"
+        << cache_hit_rate() << ",\"path_latency_us\":{\"mean\":";
+    write_micros(out, path_latency.mean());
+    out << ",\"p50\":";
+    write_micros(out, static_cast<double>(path_latency.quantile(0.5)));
+    out << ",\"p99\":";
+    write_micros(out, static_cast<double>(path_latency.quantile(0.99)));
+    out << ",\"max\":";
+    write_micros(out, static_cast<double>(
+                          path_latency.count
+                              ? HistogramSnapshot::upper_bound(highest)
+                              : 0));
+    out << "},\"phase_us\":{";
+    for (std::size_t p = 0; p < LIFECYCLE_PHASE_COUNT; ++p) {
+        out << (p ? "," : "") << '"' << PHASE_NAMES[p] << "\":";
+        write_micros(out, static_cast<double>(phase_ns[p]));
+    }
+    out << "},\"task_attempts\":" << task_attempts << ",\"task_retries\":{";
+    for (std::size_t i = 0; i < task_retries.size(); ++i) {
+        if (i)
+            out << ',';
+        write_json_string(out, task_retries[i].task);
+        out << ':' << task_retries[i].retries;
+    }
+    out << "}}";
+}
+
+MetricsRegistry::MetricsRegistry()
+    : id(next_registry_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+MetricsRegistry::Shard &MetricsRegistry::local() {
+    struct Cache {
+        std::uint64_t registry = 0;
+        Shard *shard = nullptr;
+    };
+    thread_local Cache cache;
+    if (cache.registry == id)
+        return *cache.shard;
+
+    std::lock_guard<std::mutex> lock(shards_mutex);
+    Shard *&shard = shard_of[std::this_thread::get_id()];
+    if (!shard) {
+        shards.push_back(std::make_unique<Shard>());
+        shard = shards.back().get();
+    }
+    cache = {id, shard};
+    return *shard;
+}
+
+void MetricsRegistry::record_path_query(std::uint64_t duration_ns, bool found,
+                                        std::size_t expanded) {
+    Shard &shard = local();
+    bump(shard.path_queries);
+    if (found)
+        bump(shard.paths_found);
+    bump(shard.nodes_expanded, expanded);
+    bump(shard.latency_sum, duration_ns);
+    bump(shard.latency[HistogramSnapshot::bucket_of(duration_ns)]);
+}
+
+void MetricsRegistry::record_cache_hit() { bump(local().cache_hits); }
+
+void MetricsRegistry::record_phase(LifecyclePhase phase,
+                                   std::uint64_t duration_ns) {
+    bump(local().phase_ns[static_cast<std::size_t>(phase)], duration_ns);
+}
+
+void MetricsRegistry::record_task_attempt(const std::string &task,
+                                          std::uint32_t attempt) {
+    bump(local().task_attempts);
+    if (attempt <= 1)
+        return;
+    std::lock_guard<std::mutex> lock(retries_mutex);
+    ++retries[task];
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        auto read = [](const std::atomic<std::uint64_t> &counter) {
+            return counter.load(std::memory_order_relaxed);
+        };
+        for (const auto &shard : shards) {
+            snapshot.path_queries += read(shard->path_queries);
+            snapshot.paths_found += read(shard->paths_found);
+            snapshot.nodes_expanded += read(shard->nodes_expanded);
+            snapshot.cache_hits += read(shard->cache_hits);
+            snapshot.path_latency.sum += read(shard->latency_sum);
+            for (std::size_t b = 0; b < HistogramSnapshot::BUCKETS; ++b) {
+                const std::uint64_t count = read(shard->latency[b]);
+                snapshot.path_latency.buckets[b] += count;
+                snapshot.path_latency.count += count;
+            }
+            for (std::size_t p = 0; p < LIFECYCLE_PHASE_COUNT; ++p)
+                snapshot.phase_ns[p] += read(shard->phase_ns[p]);
+            snapshot.task_attempts += read(shard->task_attempts);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(retries_mutex);
+        snapshot.task_retries.reserve(retries.size());
+        for (const auto &[task, count] : retries)
+            snapshot.task_retries.push_back({task, count});
+    }
+    std::sort(snapshot.task_retries.begin(), snapshot.task_retries.end(),
+              [](const TaskRetries &a, const TaskRetries &b) {
+                  return a.task < b.task;
+              });
+    return snapshot;
+}
+
+void MetricsRegistry::clear() {
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        auto zero = [](std::atomic<std::uint64_t> &counter) {
+            counter.store(0, std::memory_order_relaxed);
+        };
+        for (const auto &shard : shards) {
+            zero(shard->path_queries);
+            zero(shard->paths_found);
+            zero(shard->nodes_expanded);
+            zero(shard->cache_hits);
+            zero(shard->latency_sum);
+            std::for_each(shard->latency.begin(), shard->latency.end(), zero);
+            std::for_each(shard->phase_ns.begin(), shard->phase_ns.end(),
+                          zero);
+            zero(shard->task_attempts);
+        }
+    }
+    std::lock_guard<std::mutex> lock(retries_mutex);
+    retries.clear();
+}
+
+void MetricsRegistry::install(MetricsRegistry *registry) {
+    installed_registry.store(registry, std::memory_order_release);
+}
+
+MetricsRegistry *MetricsRegistry::installed() {
+    return installed_registry.load(std::memory_order_acquire);
+}
+
+} // namespace choros
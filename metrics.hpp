@@ -0,0 +1,195 @@
+#pragma once
+
+#include "lifecycle.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace choros {
+
+/// Number of `LifecyclePhase` values
+constexpr std::size_t LIFECYCLE_PHASE_COUNT =
+    static_cast<std::size_t>(LifecyclePhase::RESET) + 1;
+
+/**
+ * @brief Counts of a fixed-bucket histogram of nanosecond durations.
+ *
+ * Bucket `b` counts values `v` with `std::bit_width(v) == b`, i.e. values
+ * below `2^b` and, for `b > 0`, at least `2^(b - 1)`; the last bucket also
+ * takes everything larger. Quantiles are therefore accurate to a factor of
+ * two, which is enough to tell a 50 µs query from a 5 ms one.
+ */
+struct HistogramSnapshot {
+    static constexpr std::size_t BUCKETS = 40;
+
+    std::array<std::uint64_t, BUCKETS> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0; ///< Sum of all recorded values
+
+    /// Returns the largest value bucket `b` can count (except the last).
+    static std::uint64_t upper_bound(std::size_t bucket) {
+        return (std::uint64_t{1} << bucket) - 1;
+    }
+
+    /// Returns the bucket a value is counted in.
+    static std::size_t bucket_of(std::uint64_t value);
+
+    /// Returns the average of the recorded values, or 0 if there are none.
+    double mean() const {
+        return count ? static_cast<double>(sum) / count : 0.0;
+    }
+
+    /// Returns the upper bound of the bucket holding the `q`-quantile
+    /// (`q` in [0, 1]), or 0 if nothing was recorded.
+    std::uint64_t quantile(double q) const;
+};
+
+/**
+ * @brief Retries of one task, from `MetricsSnapshot::task_retries`.
+ */
+struct TaskRetries {
+    std::string task; ///< ID the task was added with
+    std::uint64_t retries = 0;
+};
+
+/**
+ * @brief Totals of a `MetricsRegistry` at one point in time.
+ *
+ * Counters only grow, so the difference of two snapshots gives the rates
+ * over the time between them.
+ */
+struct MetricsSnapshot {
+    /// Path queries (`find_path()` and its variants, `find_paths()`, ...)
+    std::uint64_t path_queries = 0;
+    /// Queries that found a path
+    std::uint64_t paths_found = 0;
+    /// Nodes expanded by all queries
+    std::uint64_t nodes_expanded = 0;
+    /// Queries answered by the path cache or the prefetcher
+    std::uint64_t cache_hits = 0;
+    /// Latency of path queries in nanoseconds
+    HistogramSnapshot path_latency;
+
+    /// Time spent in each lifecycle phase, in nanoseconds, by phase
+    std::array<std::uint64_t, LIFECYCLE_PHASE_COUNT> phase_ns{};
+    /// Task attempts started, including retries
+    std::uint64_t task_attempts = 0;
+    /// Retries of each task that has been retried, sorted by task ID
+    std::vector<TaskRetries> task_retries;
+
+    /// Returns the share of path queries answered without searching.
+    double cache_hit_rate() const {
+        return path_queries ? static_cast<double>(cache_hits) / path_queries
+                            : 0.0;
+    }
+
+    /**
+     * @brief Writes the snapshot as a single-line JSON object, e.g. to
+     * send it along with heartbeats.
+     *
+     * Latencies are in microseconds; the histogram is summarized by its
+     * mean, p50, p99 and maximum bucket bound.
+     */
+    void write_json(std::ostream &out) const;
+};
+
+/**
+ * @brief Live counters and histograms for navigation and lifecycle.
+ *
+ * Each thread that records gets its own shard of counters, allocated on
+ * its first update and written only by that thread, so recording neither
+ * locks nor contends: an update is a relaxed load and store of a counter
+ * in the thread's cache line. `snapshot()` sums the shards and may run
+ * concurrently with recording from any thread. Only task retries, which
+ * are rare, are counted under a mutex.
+ *
+ * The library's built-in hooks (path queries, lifecycle phases and task
+ * attempts) record into the registry passed to `install()`; with none
+ * installed, a hook costs one atomic load.
+ */
+class MetricsRegistry {
+  public:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry &) = delete;
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    /**
+     * @brief Records a finished path query.
+     *
+     * @param duration_ns Time the query took
+     * @param found Whether a path was found
+     * @param expanded Nodes the query expanded
+     */
+    void record_path_query(std::uint64_t duration_ns, bool found,
+                           std::size_t expanded);
+
+    /// Records that a path query was answered from a cache.
+    void record_cache_hit();
+
+    /// Records time spent in a lifecycle phase.
+    void record_phase(LifecyclePhase phase, std::uint64_t duration_ns);
+
+    /**
+     * @brief Records that attempt number `attempt` of a task started;
+     * attempts after the first count as retries of `task`.
+     */
+    void record_task_attempt(const std::string &task, std::uint32_t attempt);
+
+    /// Returns the totals recorded so far.
+    MetricsSnapshot snapshot() const;
+
+    /// Zeroes all metrics. Must not race with recording.
+    void clear();
+
+    /**
+     * @brief Sets the registry the built-in hooks record into (nullptr to
+     * stop). The registry must outlive its installation.
+     */
+    static void install(MetricsRegistry *registry);
+
+    /**
+     * @brief Returns the registry the built-in hooks record into, if any.
+     */
+    static MetricsRegistry *installed();
+
+  private:
+    /// Counters written by a single thread
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> path_queries{0};
+        std::atomic<std::uint64_t> paths_found{0};
+        std::atomic<std::uint64_t> nodes_expanded{0};
+        std::atomic<std::uint64_t> cache_hits{0};
+        std::atomic<std::uint64_t> latency_sum{0};
+        std::array<std::atomic<std::uint64_t>, HistogramSnapshot::BUCKETS>
+            latency{};
+        std::array<std::atomic<std::uint64_t>, LIFECYCLE_PHASE_COUNT>
+            phase_ns{};
+        std::atomic<std::uint64_t> task_attempts{0};
+    };
+
+    /// Distinguishes registries in the threads' shard caches, even if one
+    /// is allocated where a destroyed one lived
+    const std::uint64_t id;
+
+    mutable std::mutex shards_mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::unordered_map<std::thread::id, Shard *> shard_of;
+
+    mutable std::mutex retries_mutex;
+    std::unordered_map<std::string, std::uint64_t> retries;
+
+    /// Returns the calling thread's shard, creating it on first use.
+    Shard &local();
+};
+
+} // namespace choros
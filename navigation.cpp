@@ -1,27 +1,239 @@
-#include "navigation.hpp"
+#include "contraction_hierarchy.hpp"
+#include "metrics.hpp"
+#include "navigation_layout.hpp"
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <limits>
+#include <mutex>
 #include <queue>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 
 namespace choros {
 
+namespace {
+
+std::uint8_t direction_bit(Direction direction) {
+    return static_cast<std::uint8_t>(1u << (static_cast<int>(direction) / 90));
+}
+
+Direction reverse_of(Direction direction) {
+    return static_cast<Direction>((static_cast<int>(direction) + 180) % 360);
+}
+
+bool is_horizontal(Direction direction) {
+    return direction == Direction::EAST || direction == Direction::WEST;
+}
+
+/// Cost adjustment for leaving a node along `departure` after facing
+/// `arrival`; `moving` is false for a robot standing at its start node
+float turn_cost(Direction arrival, Direction departure, const TurnCosts &costs,
+                bool moving) {
+    const int delta =
+        (static_cast<int>(departure) - static_cast<int>(arrival) + 360) % 360;
+    if (delta == 0)
+        return moving ? -costs.straight_bonus : 0.0f;
+    if (delta == 180)
+        return costs.u_turn;
+    return costs.turn;
+}
+
+/// Key of the directed edge from ➜ to in `Navigation::edge_index`
+std::uint64_t edge_key(NodeId from, NodeId to) {
+    return (static_cast<std::uint64_t>(from) << 32) | to;
+}
+
+/// What motion compilation needs to know about one edge of a path
+struct MotionStep {
+    Direction direction;
+    float weight;
+    bool crossing; ///< A perpendicular line meets the edge's target
+    NodeId to;
+};
+
+/// Compiles `count` steps, the `i`-th returned by `step(i)`, into a plan
+template <typename Step>
+MotionPlan compile_steps(std::size_t count, Step step) {
+    MotionPlan plan;
+    for (std::size_t i = 0; i < count; ++i) {
+        const MotionStep next = step(i);
+        plan.distance += next.weight;
+        if (plan.commands.empty()) {
+            plan.departure = next.direction;
+            plan.commands.push_back(
+                {MotionType::DRIVE, 0, 0, 0.0f, next.to, next.direction});
+        } else if (plan.commands.back().heading != next.direction) {
+            const MotionCommand &last = plan.commands.back();
+            const std::int16_t degrees =
+                turn_angle(last.heading, next.direction);
+            plan.commands.push_back({MotionType::TURN, degrees, 0, 0.0f,
+                                     last.node, next.direction});
+            plan.commands.push_back(
+                {MotionType::DRIVE, 0, 0, 0.0f, next.to, next.direction});
+        }
+
+        MotionCommand &drive = plan.commands.back();
+        drive.distance += next.weight;
+        drive.intersections += next.crossing ? 1 : 0;
+        drive.node = next.to;
+    }
+    return plan;
+}
+
+void count_cache_hit() {
+    if (auto *metrics = MetricsRegistry::installed())
+        metrics->record_cache_hit();
+}
+
+} // namespace
+
+struct Navigation::MotionCache {
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, std::shared_ptr<const MotionPlan>> plans;
+};
+
+struct Navigation::Prefetcher {
+    /// Searches run on `graph`, a copy without a prefetcher of its own
+    explicit Prefetcher(const Navigation &navigation) : graph(navigation) {
+        graph.prefetcher.reset();
+    }
+
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    /// Replaces the queued routes with `keys`, keeping finished ones that
+    /// are still wanted; they are planned with `mode`.
+    void request(const std::vector<std::uint64_t> &keys, SearchStrategy mode) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            strategy = mode;
+            queue.clear();
+            std::unordered_map<std::uint64_t, Route> kept;
+            for (std::uint64_t key : keys) {
+                auto it = routes.find(key);
+                if (it != routes.end())
+                    kept.insert(routes.extract(it));
+                else if (key != in_flight)
+                    queue.push_back(key);
+            }
+            routes = std::move(kept);
+            if (!worker.joinable())
+                worker = std::thread(&Prefetcher::run, this);
+        }
+        wake.notify_one();
+    }
+
+    /// Takes the finished route for `key` into `reversed`. Returns nullopt
+    /// if there is none, otherwise whether a path exists.
+    std::optional<bool> take(std::uint64_t key,
+                             std::vector<std::uint32_t> &reversed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = routes.find(key);
+        if (it == routes.end())
+            return std::nullopt;
+        const bool found = it->second.found;
+        reversed.swap(it->second.reversed);
+        routes.erase(it);
+        return found;
+    }
+
+    /// Like `take()`, but copies the route and leaves it for the robot's
+    /// own query.
+    std::optional<bool> peek(std::uint64_t key,
+                             std::vector<std::uint32_t> &reversed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = routes.find(key);
+        if (it == routes.end())
+            return std::nullopt;
+        reversed.assign(it->second.reversed.begin(),
+                        it->second.reversed.end());
+        return it->second.found;
+    }
+
+    void run() {
+        PathWorkspace workspace;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stop || !queue.empty(); });
+            if (stop)
+                return;
+            in_flight = queue.front();
+            queue.pop_front();
+            graph.search_mode = strategy;
+            lock.unlock();
+
+            const NodeId from = static_cast<NodeId>(in_flight >> 32);
+            const NodeId to = static_cast<NodeId>(in_flight);
+            Route route;
+            workspace.begin(graph.node_count());
+            route.found = graph.search_route(from, to, nullptr, workspace);
+            if (route.found)
+                route.reversed = workspace.path_edges();
+
+            lock.lock();
+            routes[in_flight] = std::move(route);
+            in_flight = NO_KEY;
+        }
+    }
+
+    struct Route {
+        bool found = false;
+        std::vector<std::uint32_t> reversed; ///< CSR edges, last first
+    };
+
+    static constexpr std::uint64_t NO_KEY = ~std::uint64_t{0};
+
+    Navigation graph;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::uint64_t> queue;
+    std::unordered_map<std::uint64_t, Route> routes;
+    std::uint64_t in_flight = NO_KEY;
+    SearchStrategy strategy = SearchStrategy::DIJKSTRA;
+    bool stop = false;
+    std::thread worker; ///< Started by the first `request()`
+};
+
 void Navigation::add_node(const std::string &node, NodeType type) {
+    const float unknown = std::numeric_limits<float>::quiet_NaN();
+    add_node(node, type, Position{unknown, unknown});
+}
+
+void Navigation::add_node(const std::string &node, NodeType type,
+                          Position position) {
+    if (layout)
+        throw std::logic_error("Cannot add node to a frozen graph: " + node);
     if (node_types.find(node) != node_types.end()) {
         throw std::invalid_argument("Node already exists: " + node);
     }
     node_types[node] = type;
     adjacency_list[node] = {};
+    node_ids[node] = static_cast<NodeId>(node_names.size());
+    node_names.push_back(node);
+    node_positions.push_back(position);
 }
 
 void Navigation::add_edge(const std::string &from, const std::string &to,
                           float weight, Direction direction) {
+    if (layout)
+        throw std::logic_error("Cannot add edge to a frozen graph.");
     if (node_types.find(from) == node_types.end() ||
         node_types.find(to) == node_types.end()) {
         throw std::invalid_argument(
             "Both nodes must be added before adding an edge.");
     }
+    if (from == to)
+        throw std::invalid_argument("Edge cannot connect '" + from +
+                                    "' to itself.");
 
     if (node_types[from] == NodeType::SECONDARY &&
         !adjacency_list[from].empty()) {
@@ -33,32 +245,1045 @@ void Navigation::add_edge(const std::string &from, const std::string &to,
                                "' may only have one edge.");
     }
 
-    Direction reverse =
-        static_cast<Direction>((static_cast<int>(direction) + 180) % 360);
+    const NodeId from_id = node_ids.at(from);
+    const NodeId to_id = node_ids.at(to);
+    if (edge_index.count(edge_key(from_id, to_id)) ||
+        edge_index.count(edge_key(to_id, from_id))) {
+        throw std::logic_error("Edge already exists: " + from + " -> " + to);
+    }
 
-    adjacency_list[from].push_back({to, weight, direction});
-    adjacency_list[to].push_back({from, weight, reverse});
+    std::vector<Edge> &from_edges = adjacency_list[from];
+    std::vector<Edge> &to_edges = adjacency_list[to];
+    edge_index[edge_key(from_id, to_id)] =
+        static_cast<std::uint32_t>(from_edges.size());
+    from_edges.push_back({to, weight, direction});
+    edge_index[edge_key(to_id, from_id)] =
+        static_cast<std::uint32_t>(to_edges.size());
+    to_edges.push_back({from, weight, reverse_of(direction)});
 
     // Update intersection info for reverse edges ending at `from`
-    for (const auto &out_edge : adjacency_list[from]) {
-        for (auto &rev_edge : adjacency_list[out_edge.to]) {
-            if (rev_edge.to != from)
-                continue;
+    for (const auto &out_edge : from_edges) {
+        const NodeId neighbor = node_ids.at(out_edge.to);
+        Edge &rev_edge = adjacency_list[out_edge.to].at(
+            edge_index.at(edge_key(neighbor, from_id)));
 
-            if (rev_edge.orientation() == EdgeOrientation::HORIZONTAL) {
-                rev_edge.intersection_north |= (direction == Direction::NORTH);
-                rev_edge.intersection_south |= (direction == Direction::SOUTH);
-            } else {
-                rev_edge.intersection_west |= (direction == Direction::WEST);
-                rev_edge.intersection_east |= (direction == Direction::EAST);
+        if (rev_edge.orientation() == EdgeOrientation::HORIZONTAL) {
+            rev_edge.intersection_north |= (direction == Direction::NORTH);
+            rev_edge.intersection_south |= (direction == Direction::SOUTH);
+        } else {
+            rev_edge.intersection_west |= (direction == Direction::WEST);
+            rev_edge.intersection_east |= (direction == Direction::EAST);
+        }
+    }
+}
+
+Navigation Navigation::build(const std::vector<NodeSpec> &nodes,
+                             const std::vector<EdgeSpec> &edges) {
+    Navigation nav;
+    nav.node_names.reserve(nodes.size());
+    nav.node_ids.reserve(nodes.size());
+    nav.node_types.reserve(nodes.size());
+    nav.node_positions.reserve(nodes.size());
+
+    const float unknown = std::numeric_limits<float>::quiet_NaN();
+    for (const NodeSpec &spec : nodes) {
+        if (!nav.node_types.emplace(spec.name, spec.type).second)
+            throw std::invalid_argument("Node already exists: " + spec.name);
+        nav.node_ids.emplace(spec.name,
+                             static_cast<NodeId>(nav.node_names.size()));
+        nav.node_names.push_back(spec.name);
+        nav.node_positions.push_back(
+            spec.position.value_or(Position{unknown, unknown}));
+    }
+
+    // Resolve and validate every edge before laying anything out
+    const std::size_t n = nodes.size();
+    std::vector<std::pair<NodeId, NodeId>> ends;
+    ends.reserve(edges.size());
+    std::vector<std::uint32_t> degree(n, 0);
+    nav.edge_index.reserve(2 * edges.size());
+    for (const EdgeSpec &spec : edges) {
+        auto from_it = nav.node_ids.find(spec.from);
+        auto to_it = nav.node_ids.find(spec.to);
+        if (from_it == nav.node_ids.end() || to_it == nav.node_ids.end()) {
+            throw std::invalid_argument(
+                "Both nodes must be added before adding an edge.");
+        }
+        const NodeId from = from_it->second, to = to_it->second;
+        if (from == to)
+            throw std::invalid_argument("Edge cannot connect '" + spec.from +
+                                        "' to itself.");
+        for (const std::string *name : {&spec.from, &spec.to}) {
+            const NodeId id = nav.node_ids.at(*name);
+            if (++degree[id] > 1 &&
+                nav.node_types.at(*name) == NodeType::SECONDARY) {
+                throw std::logic_error("Secondary node '" + *name +
+                                       "' may only have one edge.");
             }
         }
+        if (!nav.edge_index.emplace(edge_key(from, to), 0).second ||
+            !nav.edge_index.emplace(edge_key(to, from), 0).second) {
+            throw std::logic_error("Edge already exists: " + spec.from +
+                                   " -> " + spec.to);
+        }
+        ends.emplace_back(from, to);
     }
+
+    // Counting sort into CSR rows; each row keeps insertion order, exactly as
+    // repeated add_edge() calls would have produced
+    std::vector<std::uint32_t> row_offsets(n + 1, 0);
+    for (NodeId id = 0; id < n; ++id)
+        row_offsets[id + 1] = row_offsets[id] + degree[id];
+    const std::size_t m = 2 * edges.size();
+    std::vector<CsrEdge> csr_edges(m);
+    std::vector<NodeId> edge_sources(m);
+    std::vector<std::uint32_t> twin(m);
+    std::vector<char> outgoing(m); ///< Edge was the `from` side of its spec
+    std::vector<std::uint32_t> cursor(row_offsets.begin(),
+                                      row_offsets.end() - 1);
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const auto [from, to] = ends[i];
+        const std::uint32_t forward = cursor[from]++;
+        const std::uint32_t backward = cursor[to]++;
+        const EdgeSpec &spec = edges[i];
+        csr_edges[forward] = {to, spec.weight, spec.direction, 0};
+        csr_edges[backward] = {from, spec.weight, reverse_of(spec.direction),
+                               0};
+        edge_sources[forward] = from;
+        edge_sources[backward] = to;
+        twin[forward] = backward;
+        twin[backward] = forward;
+        outgoing[forward] = 1;
+        outgoing[backward] = 0;
+    }
+
+    // Single pass per node for the intersection flags. add_edge(F, ., D)
+    // flags D on every edge X ➜ F that exists at that moment, i.e. on the
+    // twins of F's row entries up to and including its own; so walk each row
+    // backwards, accumulating the directions of F's outgoing entries.
+    for (NodeId node = 0; node < n; ++node) {
+        std::uint8_t seen = 0;
+        for (std::uint32_t e = row_offsets[node + 1];
+             e-- > row_offsets[node];) {
+            if (outgoing[e])
+                seen |= direction_bit(csr_edges[e].direction);
+            CsrEdge &into = csr_edges[twin[e]];
+            const std::uint8_t perpendicular =
+                is_horizontal(into.direction)
+                    ? direction_bit(Direction::NORTH) |
+                          direction_bit(Direction::SOUTH)
+                    : direction_bit(Direction::EAST) |
+                          direction_bit(Direction::WEST);
+            into.intersections |= seen & perpendicular;
+        }
+    }
+
+    std::vector<std::string_view> names(nav.node_names.begin(),
+                                        nav.node_names.end());
+    std::vector<NodeType> types;
+    types.reserve(n);
+    for (const NodeSpec &spec : nodes)
+        types.push_back(spec.type);
+    nav.attach(Layout::compile(names, types, nav.node_positions, row_offsets,
+                               csr_edges, edge_sources));
+    return nav;
+}
+
+void Navigation::freeze() {
+    if (layout)
+        return;
+
+    const std::size_t n = node_names.size();
+    std::vector<std::uint32_t> row_offsets(n + 1, 0);
+    std::size_t edge_count = 0;
+    for (const auto &[_, edges] : adjacency_list)
+        edge_count += edges.size();
+    std::vector<CsrEdge> csr_edges;
+    csr_edges.reserve(edge_count);
+    std::vector<NodeId> edge_sources;
+    edge_sources.reserve(edge_count);
+    std::vector<std::string_view> names;
+    names.reserve(n);
+    std::vector<NodeType> types;
+    types.reserve(n);
+
+    for (NodeId id = 0; id < n; ++id) {
+        row_offsets[id] = static_cast<std::uint32_t>(csr_edges.size());
+        names.push_back(node_names[id]);
+        types.push_back(node_types.at(node_names[id]));
+        for (const Edge &e : adjacency_list.at(node_names[id])) {
+            std::uint8_t flags = 0;
+            if (e.intersection_east)
+                flags |= direction_bit(Direction::EAST);
+            if (e.intersection_north)
+                flags |= direction_bit(Direction::NORTH);
+            if (e.intersection_west)
+                flags |= direction_bit(Direction::WEST);
+            if (e.intersection_south)
+                flags |= direction_bit(Direction::SOUTH);
+            csr_edges.push_back(
+                {node_ids.at(e.to), e.weight, e.direction, flags});
+            edge_sources.push_back(id);
+        }
+    }
+    row_offsets[n] = static_cast<std::uint32_t>(csr_edges.size());
+
+    attach(Layout::compile(names, types, node_positions, row_offsets,
+                           csr_edges, edge_sources));
+}
+
+void Navigation::attach(std::shared_ptr<const Layout> compiled) {
+    layout = std::move(compiled);
+    row_offsets = layout->row_offsets;
+    csr_edges = layout->edges;
+    edge_sources = layout->edge_sources;
+    positions = layout->positions;
+    motion_cache = std::make_shared<MotionCache>();
+
+    // The frozen layout supersedes the construction state
+    adjacency_list = {};
+    node_types = {};
+    node_names = {};
+    node_ids = {};
+    node_positions = {};
+    edge_index = {};
+
+    prefetcher = std::make_shared<Prefetcher>(*this);
+}
+
+bool Navigation::is_frozen() const { return layout != nullptr; }
+
+std::optional<NodeId> Navigation::node_id(const std::string &node) const {
+    if (layout)
+        return layout->find_node(node);
+    auto it = node_ids.find(node);
+    if (it != node_ids.end())
+        return it->second;
+    return std::nullopt;
+}
+
+std::string_view Navigation::node_name(NodeId id) const {
+    if (!layout)
+        return node_names.at(id);
+    if (id >= layout->node_count)
+        throw std::out_of_range("Unknown node ID " + std::to_string(id));
+    return layout->name(id);
+}
+
+std::size_t Navigation::node_count() const {
+    return layout ? layout->node_count : node_names.size();
+}
+
+NodeMask Navigation::node_mask() const { return NodeMask(node_count()); }
+
+Edge Navigation::to_edge(const CsrEdge &edge) const {
+    Edge out;
+    assign_edge(out, edge);
+    return out;
+}
+
+void Navigation::assign_edge(Edge &out, const CsrEdge &edge) const {
+    const std::string_view to = layout->name(edge.to);
+    out.to.assign(to.data(), to.size());
+    out.weight = edge.weight;
+    out.direction = edge.direction;
+    out.intersection_east = edge.intersections & direction_bit(Direction::EAST);
+    out.intersection_north =
+        edge.intersections & direction_bit(Direction::NORTH);
+    out.intersection_west = edge.intersections & direction_bit(Direction::WEST);
+    out.intersection_south =
+        edge.intersections & direction_bit(Direction::SOUTH);
 }
 
 std::optional<std::vector<Edge>>
 Navigation::find_path(const std::string &to,
                       const std::unordered_set<std::string> &blacklist) const {
+    if (!layout)
+        return find_path_dynamic(to, blacklist);
+
+    // One workspace per thread keeps repeated replanning allocation-free
+    thread_local PathWorkspace workspace;
+    std::vector<Edge> path;
+    if (!find_path(to, blacklist, workspace, path))
+        return std::nullopt;
+    return path;
+}
+
+bool Navigation::find_path(const std::string &to,
+                           const std::unordered_set<std::string> &blacklist,
+                           PathWorkspace &workspace,
+                           std::vector<Edge> &path) const {
+    if (!layout) {
+        auto result = find_path_dynamic(to, blacklist);
+        if (!result.has_value()) {
+            path.clear();
+            return false;
+        }
+        path = std::move(result.value());
+        return true;
+    }
+
+    const std::uint64_t query_start = begin_query();
+    bool found = plan_path(to, blacklist, workspace, path);
+    end_query(query_start, found, workspace.expanded_nodes());
+    return found;
+}
+
+bool Navigation::plan_path(const std::string &to,
+                           const std::unordered_set<std::string> &blacklist,
+                           PathWorkspace &workspace,
+                           std::vector<Edge> &path) const {
+    workspace.begin(node_count());
+    path.clear();
+    NodeId from, target;
+    if (!resolve_endpoints(to, from, target))
+        return false;
+    return plan_between(from, target, blacklist, workspace, path, false);
+}
+
+bool Navigation::plan_between(NodeId from, NodeId target,
+                              const std::unordered_set<std::string> &blacklist,
+                              PathWorkspace &workspace,
+                              std::vector<Edge> &path, bool stateless) const {
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+
+    if (blacklist.empty()) {
+        if (!plan_route(from, target, workspace, stateless))
+            return false;
+        emit_path(reversed, path);
+        return true;
+    }
+
+    thread_local std::vector<NodeId> blocked;
+    blocked.clear();
+    block_nodes(blacklist, workspace, &blocked);
+
+    std::uint64_t hash = 0;
+    if (path_cache) {
+        std::sort(blocked.begin(), blocked.end());
+        hash = PathCache::hash_key(from, target, blocked);
+        auto cached = path_cache->lookup(hash, from, target, blocked, reversed);
+        if (cached.has_value()) {
+            count_cache_hit();
+            if (!cached.value())
+                return false;
+            emit_path(reversed, path);
+            return true;
+        }
+    }
+
+    bool found = search_route(from, target, nullptr, workspace);
+    if (!found)
+        reversed.clear();
+
+    if (path_cache)
+        path_cache->insert(hash, from, target, blocked, found, reversed);
+    if (!found)
+        return false;
+    emit_path(reversed, path);
+    return true;
+}
+
+bool Navigation::plan_route(NodeId from, NodeId to, PathWorkspace &workspace,
+                            bool stateless) const {
+    if (path_cache) {
+        count_cache_hit();
+        return cached_route(from, to, workspace);
+    }
+
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+    const std::uint64_t key = edge_key(from, to);
+    auto prefetched = stateless ? prefetcher->peek(key, reversed)
+                                : prefetcher->take(key, reversed);
+    if (prefetched.has_value()) {
+        count_cache_hit();
+        return prefetched.value();
+    }
+
+    if (hierarchy)
+        return hierarchy->route(from, to, workspace);
+    return search_route(from, to, nullptr, workspace);
+}
+
+bool Navigation::plan_route(NodeId from, NodeId to, const NodeMask &blacklist,
+                            PathWorkspace &workspace, bool stateless) const {
+    if (blacklist.none())
+        return plan_route(from, to, workspace, stateless);
+    return search_route(from, to, &blacklist, workspace);
+}
+
+std::optional<std::vector<Edge>>
+Navigation::find_path(const std::string &to, const NodeMask &blacklist) const {
+    thread_local PathWorkspace workspace;
+    std::vector<Edge> path;
+    if (!find_path(to, blacklist, workspace, path))
+        return std::nullopt;
+    return path;
+}
+
+bool Navigation::find_path(const std::string &to, const NodeMask &blacklist,
+                           PathWorkspace &workspace,
+                           std::vector<Edge> &path) const {
+    require_frozen("Searching with a node mask");
+    const std::uint64_t query_start = begin_query();
+    bool found = plan_path(to, blacklist, workspace, path);
+    end_query(query_start, found, workspace.expanded_nodes());
+    return found;
+}
+
+bool Navigation::plan_path(const std::string &to, const NodeMask &blacklist,
+                           PathWorkspace &workspace,
+                           std::vector<Edge> &path) const {
+    workspace.begin(node_count());
+    path.clear();
+    NodeId from, target;
+    if (!resolve_endpoints(to, from, target))
+        return false;
+
+    if (!plan_route(from, target, blacklist, workspace, false))
+        return false;
+    emit_path(workspace.path_edges(), path);
+    return true;
+}
+
+bool Navigation::find_edge_path(const std::string &to, EdgePath &path) const {
+    return plan_edge_path(to, nullptr, path);
+}
+
+bool Navigation::find_edge_path(const std::string &to,
+                                const NodeMask &blacklist,
+                                EdgePath &path) const {
+    return plan_edge_path(to, &blacklist, path);
+}
+
+bool Navigation::plan_edge_path(const std::string &to,
+                                const NodeMask *blacklist,
+                                EdgePath &path) const {
+    require_frozen("Searching for an edge path");
+    thread_local PathWorkspace workspace;
+    NodeId from, target;
+    if (!resolve_endpoints(to, from, target)) {
+        path.clear();
+        return false;
+    }
+    return plan_between(from, target, blacklist, workspace, path, false);
+}
+
+bool Navigation::plan_between(NodeId from, NodeId to,
+                              const NodeMask *blacklist,
+                              PathWorkspace &workspace, EdgePath &path,
+                              bool stateless) const {
+    const std::uint64_t query_start = begin_query();
+    workspace.begin(node_count());
+    path.clear();
+    const bool found =
+        from < node_count() && to < node_count() &&
+        (blacklist ? plan_route(from, to, *blacklist, workspace, stateless)
+                   : plan_route(from, to, workspace, stateless));
+    if (found)
+        emit_edge_path(workspace.path_edges(), path);
+    end_query(query_start, found, workspace.expanded_nodes());
+    return found;
+}
+
+std::optional<std::vector<Edge>> Navigation::find_path_from(
+    const std::string &from, const std::string &to,
+    const std::unordered_set<std::string> &blacklist) const {
+    require_frozen("Searching between given nodes");
+    auto from_id = layout->find_node(from);
+    auto to_id = layout->find_node(to);
+    if (!from_id.has_value() || !to_id.has_value())
+        return std::nullopt;
+
+    thread_local PathWorkspace workspace;
+    const std::uint64_t query_start = begin_query();
+    workspace.begin(node_count());
+    std::vector<Edge> path;
+    const bool found = plan_between(from_id.value(), to_id.value(),
+                                    blacklist, workspace, path, true);
+    end_query(query_start, found, workspace.expanded_nodes());
+    if (!found)
+        return std::nullopt;
+    return path;
+}
+
+bool Navigation::find_path_from(NodeId from, NodeId to, EdgePath &path) const {
+    require_frozen("Searching between given nodes");
+    thread_local PathWorkspace workspace;
+    return plan_between(from, to, nullptr, workspace, path, true);
+}
+
+bool Navigation::find_path_from(NodeId from, NodeId to,
+                                const NodeMask &blacklist,
+                                EdgePath &path) const {
+    require_frozen("Searching between given nodes");
+    thread_local PathWorkspace workspace;
+    return plan_between(from, to, &blacklist, workspace, path, true);
+}
+
+void Navigation::find_path_batch(const std::vector<PathQuery> &queries,
+                                 std::vector<PathResult> &results,
+                                 ThreadPool &pool) const {
+    require_frozen("Batch path queries");
+    results.resize(queries.size());
+    pool.parallel_for(queries.size(), [&](std::size_t i, std::size_t) {
+        // The pool's threads persist, so their workspaces stay warm
+        thread_local PathWorkspace workspace;
+        const PathQuery &query = queries[i];
+        results[i].found = plan_between(query.from, query.to, query.blacklist,
+                                        workspace, results[i].path, true);
+    });
+}
+
+void Navigation::materialize(const EdgePath &path,
+                             std::vector<Edge> &edges) const {
+    edges.resize(path.size());
+    for (std::size_t i = 0; i < path.size(); ++i)
+        assign_edge(edges[i], csr_edges[path[i]]);
+}
+
+std::size_t Navigation::mark_targets(const std::vector<std::string> &targets,
+                                     NodeId from,
+                                     const PathWorkspace &workspace,
+                                     std::vector<NodeId> &ids,
+                                     NodeMask &pending) const {
+    ids.assign(targets.size(), NO_NODE);
+    pending.resize(node_count());
+    pending.clear();
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        auto id = layout->find_node(targets[i]);
+        if (!id.has_value())
+            continue;
+        ids[i] = id.value();
+        if (id.value() == from || workspace.blocked(id.value()) ||
+            pending.test(id.value()))
+            continue;
+        pending.set(id.value());
+        ++count;
+    }
+    return count;
+}
+
+TargetPaths
+Navigation::find_paths(const std::vector<std::string> &targets,
+                       const std::unordered_set<std::string> &blacklist) const {
+    require_frozen("Multi-target search");
+    const std::uint64_t query_start = begin_query();
+    thread_local PathWorkspace workspace;
+    thread_local NodeMask pending(0);
+    thread_local std::vector<NodeId> ids;
+    workspace.begin(node_count());
+
+    TargetPaths result;
+    result.navigation = this;
+    result.targets = targets;
+    result.distances.assign(targets.size(),
+                            std::numeric_limits<float>::infinity());
+    result.offsets.assign(targets.size() + 1, 0);
+
+    std::optional<NodeId> from;
+    if (current_node.has_value())
+        from = layout->find_node(current_node.value());
+    if (!from.has_value()) {
+        end_query(query_start, false, 0);
+        return result;
+    }
+    block_nodes(blacklist, workspace, nullptr);
+
+    std::size_t remaining =
+        mark_targets(targets, from.value(), workspace, ids, pending);
+    if (remaining > 0) {
+        expand_until(
+            from.value(), workspace, [](NodeId) { return 0.0f; },
+            [&](NodeId node) { return workspace.blocked(node); },
+            [&](NodeId node) {
+                if (!pending.test(node))
+                    return false;
+                pending.reset(node);
+                return --remaining == 0;
+            });
+    }
+
+    // Collect each reachable path, walking parent edges back from the target
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        const NodeId target = ids[i];
+        const std::size_t begin = result.edges.size();
+        if (target != NO_NODE &&
+            workspace.parent_edge(target) != PathWorkspace::NO_EDGE) {
+            result.distances[i] = workspace.distance(target);
+            for (NodeId v = target; v != from.value();) {
+                const std::uint32_t e = workspace.parent_edge(v);
+                result.edges.push_back(e);
+                v = edge_sources[e];
+            }
+            std::reverse(result.edges.begin() + begin, result.edges.end());
+        }
+        result.offsets[i + 1] = static_cast<std::uint32_t>(result.edges.size());
+    }
+    end_query(query_start, !result.edges.empty(),
+              workspace.expanded_nodes());
+    return result;
+}
+
+std::optional<NearestTarget> Navigation::find_nearest(
+    const std::vector<std::string> &targets,
+    const std::unordered_set<std::string> &blacklist) const {
+    require_frozen("Nearest-target search");
+    const std::uint64_t query_start = begin_query();
+    thread_local PathWorkspace workspace;
+    thread_local NodeMask pending(0);
+    thread_local std::vector<NodeId> ids;
+    workspace.begin(node_count());
+
+    std::optional<NodeId> from;
+    if (current_node.has_value())
+        from = layout->find_node(current_node.value());
+    NodeId nearest = NO_NODE;
+    if (from.has_value()) {
+        block_nodes(blacklist, workspace, nullptr);
+        if (mark_targets(targets, from.value(), workspace, ids, pending) > 0) {
+            expand_until(
+                from.value(), workspace, [](NodeId) { return 0.0f; },
+                [&](NodeId node) { return workspace.blocked(node); },
+                [&](NodeId node) {
+                    if (!pending.test(node))
+                        return false;
+                    nearest = node;
+                    return true;
+                });
+        }
+    }
+    end_query(query_start, nearest != NO_NODE,
+              workspace.expanded_nodes());
+    if (nearest == NO_NODE)
+        return std::nullopt;
+
+    NearestTarget result;
+    result.index = static_cast<std::size_t>(
+        std::find(ids.begin(), ids.end(), nearest) - ids.begin());
+    result.target = targets[result.index];
+    result.distance = workspace.distance(nearest);
+    reconstruct(from.value(), nearest, workspace);
+    emit_path(workspace.path_edges(), result.path);
+    return result;
+}
+
+std::shared_ptr<const MotionPlan>
+Navigation::motion_plan(const std::string &to) const {
+    require_frozen("Compiling motion plans");
+    NodeId from, target;
+    if (!resolve_endpoints(to, from, target))
+        return nullptr;
+
+    const std::uint64_t key = edge_key(from, target);
+    {
+        std::lock_guard<std::mutex> lock(motion_cache->mutex);
+        auto it = motion_cache->plans.find(key);
+        if (it != motion_cache->plans.end())
+            return it->second;
+    }
+
+    // Plan outside the lock; a racing thread at worst compiles it twice
+    thread_local EdgePath path;
+    std::shared_ptr<const MotionPlan> plan;
+    if (find_edge_path(to, path))
+        plan = std::make_shared<const MotionPlan>(compile_motion(path));
+
+    std::lock_guard<std::mutex> lock(motion_cache->mutex);
+    return motion_cache->plans.emplace(key, std::move(plan)).first->second;
+}
+
+void Navigation::prefetch(const std::string &from,
+                          const std::vector<std::string> &targets) const {
+    require_frozen("Prefetching paths");
+    auto start = layout->find_node(from);
+    if (!start.has_value())
+        return;
+    std::vector<std::uint64_t> keys;
+    keys.reserve(targets.size());
+    for (const std::string &target : targets) {
+        auto id = layout->find_node(target);
+        if (id.has_value() && id.value() != start.value())
+            keys.push_back(edge_key(start.value(), id.value()));
+    }
+    prefetcher->request(keys, search_mode);
+}
+
+MotionPlan Navigation::compile_motion(const EdgePath &path) const {
+    return compile_steps(path.size(), [&](std::size_t i) {
+        const CsrEdge &edge = csr_edges[path[i]];
+        return MotionStep{edge.direction, edge.weight, edge.intersections != 0,
+                          edge.to};
+    });
+}
+
+MotionPlan Navigation::compile_motion(const std::vector<Edge> &path) const {
+    return compile_steps(path.size(), [&](std::size_t i) {
+        const Edge &edge = path[i];
+        const bool crossing = edge.intersection_east ||
+                              edge.intersection_north ||
+                              edge.intersection_west || edge.intersection_south;
+        return MotionStep{edge.direction, edge.weight, crossing,
+                          node_id(edge.to).value_or(NO_NODE)};
+    });
+}
+
+std::optional<std::vector<Edge>> TargetPaths::path(std::size_t index) const {
+    std::vector<Edge> result;
+    if (!path(index, result))
+        return std::nullopt;
+    return result;
+}
+
+bool TargetPaths::path(std::size_t index, std::vector<Edge> &path) const {
+    const std::uint32_t begin = offsets.at(index), end = offsets.at(index + 1);
+    path.resize(end - begin);
+    for (std::uint32_t i = begin; i < end; ++i)
+        path[i - begin] = navigation->edge_at(edges[i]);
+    return begin != end;
+}
+
+std::optional<std::vector<Edge>>
+Navigation::find_path_turns(const std::string &to, const TurnCosts &costs,
+                            const std::unordered_set<std::string> &blacklist,
+                            std::optional<Direction> heading) const {
+    thread_local PathWorkspace workspace;
+    std::vector<Edge> path;
+    if (!find_path_turns(to, costs, blacklist, workspace, path, heading))
+        return std::nullopt;
+    return path;
+}
+
+bool Navigation::find_path_turns(
+    const std::string &to, const TurnCosts &costs,
+    const std::unordered_set<std::string> &blacklist, PathWorkspace &workspace,
+    std::vector<Edge> &path, std::optional<Direction> heading) const {
+    require_frozen("Turn-aware search");
+    // Edge states make a bitset cheaper to probe than the workspace stamps
+    thread_local NodeMask mask(0);
+    mask.resize(node_count());
+    mask.clear();
+    for (const auto &node : blacklist) {
+        auto id = layout->find_node(node);
+        if (id.has_value())
+            mask.set(id.value());
+    }
+    return find_path_turns(to, costs, mask, workspace, path, heading);
+}
+
+bool Navigation::find_path_turns(const std::string &to, const TurnCosts &costs,
+                                 const NodeMask &blacklist,
+                                 PathWorkspace &workspace,
+                                 std::vector<Edge> &path,
+                                 std::optional<Direction> heading) const {
+    require_frozen("Turn-aware search");
+    const std::uint64_t query_start = begin_query();
+    path.clear();
+    NodeId from, target;
+    bool found = resolve_endpoints(to, from, target) &&
+                 turn_search(from, target, costs, heading, blacklist,
+                             workspace);
+    if (found)
+        emit_path(workspace.path_edges(), path);
+    end_query(query_start, found, workspace.expanded_nodes());
+    return found;
+}
+
+bool Navigation::turn_search(NodeId from, NodeId to, const TurnCosts &costs,
+                             std::optional<Direction> heading,
+                             const NodeMask &blocked,
+                             PathWorkspace &workspace) const {
+    // State `e` is "arrived over CSR edge e"; `start` is the robot standing
+    // at `from`. Parent links in the workspace point at previous states.
+    const auto start = static_cast<std::uint32_t>(csr_edges.size());
+    workspace.begin(csr_edges.size() + 1);
+    if (from == to || blocked.test(from) || blocked.test(to))
+        return false;
+    workspace.set(start, 0.0f, PathWorkspace::NO_EDGE);
+    workspace.push(0.0f, start);
+
+    PathWorkspace::HeapEntry top;
+    while (workspace.pop(top)) {
+        const std::uint32_t state = top.node;
+        const float g = workspace.distance(state);
+        if (top.key > g)
+            continue; // Stale heap entry
+
+        const NodeId node = state == start ? from : csr_edges[state].to;
+        if (node == to) {
+            std::vector<std::uint32_t> &reversed = workspace.path_edges();
+            reversed.clear();
+            for (std::uint32_t s = state; s != start;
+                 s = workspace.parent_edge(s))
+                reversed.push_back(s);
+            return true;
+        }
+        workspace.count_expansion();
+
+        for (std::uint32_t e = row_offsets[node]; e < row_offsets[node + 1];
+             ++e) {
+            const CsrEdge &edge = csr_edges[e];
+            if (blocked.test(edge.to))
+                continue;
+
+            float step = edge.weight;
+            if (state != start)
+                step += turn_cost(csr_edges[state].direction, edge.direction,
+                                  costs, true);
+            else if (heading.has_value())
+                step += turn_cost(heading.value(), edge.direction, costs,
+                                  false);
+            const float alt = g + std::max(step, 0.0f);
+            if (alt < workspace.distance(e)) {
+                workspace.set(e, alt, state);
+                workspace.push(alt, e);
+            }
+        }
+    }
+    return false;
+}
+
+bool Navigation::cached_route(NodeId from, NodeId to,
+                              PathWorkspace &workspace) const {
+    const std::uint32_t *row =
+        path_cache->parent.data() + from * path_cache->node_count;
+    if (row[to] == PathWorkspace::NO_EDGE)
+        return false;
+
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+    reversed.clear();
+    for (NodeId v = to; v != from; v = edge_sources[reversed.back()])
+        reversed.push_back(row[v]);
+    return true;
+}
+
+void Navigation::build_path_cache(std::size_t lru_capacity) {
+    require_frozen("Building a path cache");
+
+    auto cache = std::make_shared<PathCache>();
+    const std::size_t n = node_count();
+    cache->node_count = n;
+    cache->dist_storage.assign(n * n, std::numeric_limits<float>::infinity());
+    cache->parent_storage.assign(n * n, PathWorkspace::NO_EDGE);
+    cache->lru_capacity = lru_capacity;
+
+    PathWorkspace workspace(n);
+    for (NodeId from = 0; from < n; ++from) {
+        workspace.begin(n);
+        search(from, NO_NODE, workspace);
+        for (NodeId to = 0; to < n; ++to) {
+            if (to == from || !workspace.touched(to))
+                continue;
+            cache->dist_storage[from * n + to] = workspace.distance(to);
+            cache->parent_storage[from * n + to] = workspace.parent_edge(to);
+        }
+    }
+    cache->dist = {cache->dist_storage.data(), n * n};
+    cache->parent = {cache->parent_storage.data(), n * n};
+
+    path_cache = std::move(cache);
+}
+
+bool Navigation::has_path_cache() const { return path_cache != nullptr; }
+
+void Navigation::build_contraction_hierarchy() {
+    require_frozen("Building a contraction hierarchy");
+    hierarchy = std::make_shared<const ContractionHierarchy>(*this);
+}
+
+bool Navigation::has_contraction_hierarchy() const {
+    return hierarchy != nullptr;
+}
+
+std::uint64_t Navigation::begin_query() {
+#ifdef CHOROS_ENABLE_TRACING
+    return trace_now();
+#else
+    return MetricsRegistry::installed() ? trace_now() : 0;
+#endif
+}
+
+void Navigation::end_query(std::uint64_t start, bool found,
+                           std::size_t expanded) {
+    CHOROS_TRACE_EVENT(TraceEvent::path_search(start, found, expanded));
+    if (start == 0)
+        return;
+    if (auto *metrics = MetricsRegistry::installed())
+        metrics->record_path_query(trace_now() - start, found, expanded);
+}
+
+void Navigation::require_frozen(const char *operation) const {
+    if (!layout)
+        throw std::logic_error(std::string(operation) +
+                               " requires a frozen graph.");
+}
+
+bool Navigation::resolve_endpoints(const std::string &to, NodeId &from,
+                                   NodeId &target) const {
+    if (!current_node.has_value())
+        return false;
+    auto from_id = layout->find_node(current_node.value());
+    auto to_id = layout->find_node(to);
+    if (!from_id.has_value() || !to_id.has_value())
+        return false;
+    from = from_id.value();
+    target = to_id.value();
+    return true;
+}
+
+void Navigation::block_nodes(const std::unordered_set<std::string> &blacklist,
+                             PathWorkspace &workspace,
+                             std::vector<NodeId> *ids) const {
+    for (const auto &node : blacklist) {
+        auto id = layout->find_node(node);
+        if (!id.has_value())
+            continue;
+        workspace.block(id.value());
+        if (ids)
+            ids->push_back(id.value());
+    }
+}
+
+bool Navigation::search(NodeId from, NodeId to,
+                        PathWorkspace &workspace) const {
+    return best_first_search(
+        from, to, workspace, [](NodeId) { return 0.0f; },
+        [&](NodeId node) { return workspace.blocked(node); });
+}
+
+bool Navigation::search_route(NodeId from, NodeId to,
+                              const NodeMask *blacklist,
+                              PathWorkspace &workspace) const {
+    auto route = [&](auto is_blocked) {
+        if (search_mode == SearchStrategy::BIDIRECTIONAL)
+            return bidirectional_search(from, to, workspace, is_blocked);
+        if (!best_first_search(from, to, workspace,
+                               [](NodeId) { return 0.0f; }, is_blocked))
+            return false;
+        reconstruct(from, to, workspace);
+        return true;
+    };
+    if (blacklist)
+        return route([&](NodeId node) { return blacklist->test(node); });
+    return route([&](NodeId node) { return workspace.blocked(node); });
+}
+
+template <typename Blocked>
+bool Navigation::bidirectional_search(NodeId from, NodeId to,
+                                      PathWorkspace &workspace,
+                                      Blocked is_blocked) const {
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+    reversed.clear();
+    if (from == to || is_blocked(from) || is_blocked(to))
+        return false;
+
+    // Edges come in pairs of equal weight, so the backward search can walk
+    // out-edges too; its parent edges point away from the path direction
+    thread_local PathWorkspace backward;
+    backward.begin(node_count());
+    workspace.set(from, 0.0f, PathWorkspace::NO_EDGE);
+    workspace.push(0.0f, from);
+    backward.set(to, 0.0f, PathWorkspace::NO_EDGE);
+    backward.push(0.0f, to);
+
+    float best = std::numeric_limits<float>::infinity();
+    NodeId meet = NO_NODE;
+    PathWorkspace::HeapEntry top{};
+    while (true) {
+        // No path through unsettled nodes can beat `best` any more
+        const float forward_key = workspace.min_key();
+        const float backward_key = backward.min_key();
+        if (forward_key + backward_key >= best)
+            break;
+
+        const bool forward = forward_key <= backward_key;
+        PathWorkspace &side = forward ? workspace : backward;
+        const PathWorkspace &other = forward ? backward : workspace;
+        side.pop(top);
+        const NodeId u = top.node;
+        const float g = side.distance(u);
+        if (top.key > g)
+            continue; // Stale heap entry
+        workspace.count_expansion();
+
+        for (std::uint32_t e = row_offsets[u]; e < row_offsets[u + 1]; ++e) {
+            const CsrEdge &edge = csr_edges[e];
+            if (is_blocked(edge.to))
+                continue;
+
+            const float alt = g + edge.weight;
+            if (alt < side.distance(edge.to)) {
+                side.set(edge.to, alt, e);
+                side.push(alt, edge.to);
+                const float through = alt + other.distance(edge.to);
+                if (through < best) {
+                    best = through;
+                    meet = edge.to;
+                }
+            }
+        }
+    }
+    if (meet == NO_NODE)
+        return false;
+
+    // Edges from `meet` to `to`, reversed into driving direction, then
+    // flipped so that the path's last edge comes first
+    for (NodeId v = meet; v != to;) {
+        const std::uint32_t e = backward.parent_edge(v);
+        reversed.push_back(reverse_edge(e));
+        v = edge_sources[e];
+    }
+    std::reverse(reversed.begin(), reversed.end());
+    for (NodeId v = meet; v != from;) {
+        const std::uint32_t e = workspace.parent_edge(v);
+        reversed.push_back(e);
+        v = edge_sources[e];
+    }
+    return true;
+}
+
+std::uint32_t Navigation::reverse_edge(std::uint32_t edge) const {
+    const NodeId from = edge_sources[edge];
+    const NodeId to = csr_edges[edge].to;
+    for (std::uint32_t e = row_offsets[to]; e < row_offsets[to + 1]; ++e) {
+        if (csr_edges[e].to == from)
+            return e;
+    }
+    throw std::logic_error("Edge " + std::to_string(edge) +
+                           " has no reverse edge.");
+}
+
+void Navigation::reconstruct(NodeId from, NodeId to,
+                             PathWorkspace &workspace) const {
+    // Walk parent edges back to the source
+    std::vector<std::uint32_t> &reversed = workspace.path_edges();
+    reversed.clear();
+    for (NodeId v = to; v != from;) {
+        std::uint32_t e = workspace.parent_edge(v);
+        reversed.push_back(e);
+        v = edge_sources[e];
+    }
+}
+
+void Navigation::emit_path(const std::vector<std::uint32_t> &reversed,
+                           std::vector<Edge> &path) const {
+    path.resize(reversed.size());
+    for (std::size_t i = 0; i < reversed.size(); ++i)
+        assign_edge(path[i], csr_edges[reversed[reversed.size() - 1 - i]]);
+}
+
+void Navigation::emit_edge_path(const std::vector<std::uint32_t> &reversed,
+                                EdgePath &path) const {
+    path.assign(reversed.rbegin(), reversed.rend());
+    path.length = 0.0f;
+    for (std::uint32_t e : reversed)
+        path.length += csr_edges[e].weight;
+}
+
+std::optional<std::vector<Edge>> Navigation::find_path_dynamic(
+    const std::string &to,
+    const std::unordered_set<std::string> &blacklist) const {
     if (!current_node.has_value())
         return std::nullopt;
 
@@ -129,8 +1354,26 @@ void Navigation::set_node(const std::optional<std::string> &id) {
     current_node = id;
 }
 
+std::optional<Position>
+Navigation::get_node_position(const std::string &node) const {
+    auto id = node_id(node);
+    if (!id.has_value())
+        return std::nullopt;
+    const Position &position =
+        layout ? positions[id.value()] : node_positions[id.value()];
+    if (std::isnan(position.x))
+        return std::nullopt;
+    return position;
+}
+
 std::optional<NodeType>
 Navigation::get_node_type(const std::string &node) const {
+    if (layout) {
+        auto id = layout->find_node(node);
+        if (id.has_value())
+            return layout->type(id.value());
+        return std::nullopt;
+    }
     auto it = node_types.find(node);
     if (it != node_types.end())
         return it->second;
@@ -139,18 +1382,36 @@ Navigation::get_node_type(const std::string &node) const {
 
 std::optional<Edge> Navigation::get_edge(const std::string &from,
                                          const std::string &to) const {
-    if (node_types.find(from) == node_types.end() ||
-        node_types.find(to) == node_types.end()) {
+    auto from_id = node_id(from);
+    auto to_id = node_id(to);
+    if (!from_id.has_value() || !to_id.has_value()) {
         throw std::invalid_argument(
             "Both nodes must be added before searching for an edge.");
     }
 
-    std::optional<Edge> edge = std::nullopt;
-    for (auto &e : adjacency_list.at(from)) {
-        if (e.to == to)
-            return e;
+    if (layout) {
+        std::uint32_t e = layout->find_edge(from_id.value(), to_id.value());
+        if (e == PathWorkspace::NO_EDGE)
+            return std::nullopt;
+        return to_edge(csr_edges[e]);
     }
-    return std::nullopt;
+    auto it = edge_index.find(edge_key(from_id.value(), to_id.value()));
+    if (it == edge_index.end())
+        return std::nullopt;
+    return adjacency_list.at(from).at(it->second);
+}
+
+std::optional<std::uint32_t> Navigation::edge_id(std::string_view from,
+                                                 std::string_view to) const {
+    require_frozen("Looking up edge IDs");
+    auto from_id = layout->find_node(from);
+    auto to_id = layout->find_node(to);
+    if (!from_id.has_value() || !to_id.has_value())
+        return std::nullopt;
+    std::uint32_t e = layout->find_edge(from_id.value(), to_id.value());
+    if (e == PathWorkspace::NO_EDGE)
+        return std::nullopt;
+    return e;
 }
 
 } // namespace choros
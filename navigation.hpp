@@ -1,7 +1,18 @@
 #pragma once
 
+#include "array_view.hpp"
+#include "edge_path.hpp"
+#include "node_mask.hpp"
+#include "path_workspace.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -47,22 +58,262 @@ struct Edge {
     }
 };
 
+/**
+ * @brief Field coordinates of a node (in the same unit as edge weights).
+ */
+struct Position {
+    float x;
+    float y;
+};
+
+/**
+ * @brief A* heuristic: Manhattan distance between two positions.
+ *
+ * Admissible as long as every edge weight is at least `scale` times the
+ * Manhattan distance between its endpoints, which holds for axis-aligned
+ * Botball lines measured in the same unit as the coordinates.
+ */
+struct ManhattanHeuristic {
+    float scale = 1.0f;
+
+    float operator()(const Position &a, const Position &b) const {
+        return scale * (std::fabs(a.x - b.x) + std::fabs(a.y - b.y));
+    }
+};
+
+/**
+ * @brief A* heuristic: straight-line distance between two positions.
+ *
+ * Admissible as long as every edge weight is at least `scale` times the
+ * straight-line distance between its endpoints.
+ */
+struct EuclideanHeuristic {
+    float scale = 1.0f;
+
+    float operator()(const Position &a, const Position &b) const {
+        return scale * std::hypot(a.x - b.x, a.y - b.y);
+    }
+};
+
+/**
+ * @brief Packed edge record used by the frozen (CSR) graph layout.
+ *
+ * Mirrors `Edge`, but refers to its target by `NodeId` and stores the
+ * intersection flags as a bitmask (bit `static_cast<int>(direction) / 90`).
+ */
+struct CsrEdge {
+    NodeId to;
+    float weight;
+    Direction direction;
+    std::uint8_t intersections;
+};
+
+/**
+ * @brief Heading-change costs for `Navigation::find_path_turns()`.
+ *
+ * Each step along a path costs its edge weight, plus `turn` if it leaves a
+ * node 90° off the heading the robot arrived with, plus `u_turn` if it
+ * reverses, minus `straight_bonus` if it drives straight on without
+ * stopping. Steps are clamped at zero cost. All values are in the unit of
+ * the edge weights, typically time.
+ */
+struct TurnCosts {
+    float turn = 0.0f;
+    float u_turn = 0.0f;
+    float straight_bonus = 0.0f;
+};
+
+/**
+ * @brief Algorithm behind point-to-point queries, see
+ * `Navigation::set_search_strategy()`.
+ */
+enum class SearchStrategy : std::uint8_t {
+    /// Dijkstra from the start node until the target is settled
+    DIJKSTRA,
+    /// Dijkstra from both endpoints until the two frontiers meet
+    BIDIRECTIONAL
+};
+
+/**
+ * @brief Kind of a `MotionCommand`.
+ */
+enum class MotionType : std::uint8_t { DRIVE, TURN };
+
+/**
+ * @brief One command of a compiled motion plan.
+ *
+ * A `DRIVE` follows the line along `heading` over one or more collinear
+ * edges to `node`. `intersections` counts the perpendicular lines it crosses
+ * on the way, including one at `node` itself, so a line follower that counts
+ * crossings knows where to stop. A `TURN` turns on the spot at `node` by
+ * `degrees` (counter-clockwise positive: 90, -90 or 180) to face `heading`.
+ */
+struct MotionCommand {
+    MotionType type;
+    std::int16_t degrees;        ///< TURN only
+    std::uint16_t intersections; ///< DRIVE only
+    float distance;              ///< DRIVE only, sum of the edge weights
+    NodeId node;
+    Direction heading; ///< Heading once the command is done
+};
+
+/**
+ * @brief A route compiled into drive and turn commands.
+ *
+ * Starts with a `DRIVE` along `departure`; a robot facing elsewhere turns by
+ * `turn_angle(heading, departure)` first. Commands alternate between drives
+ * and turns.
+ */
+struct MotionPlan {
+    std::vector<MotionCommand> commands;
+    Direction departure = Direction::EAST;
+    float distance = 0.0f; ///< Length of the whole route
+};
+
+/**
+ * @brief Returns the turn from heading `from` to heading `to` in degrees,
+ * counter-clockwise positive: 0, 90, -90 or 180.
+ */
+inline std::int16_t turn_angle(Direction from, Direction to) {
+    const int delta =
+        (static_cast<int>(to) - static_cast<int>(from) + 360) % 360;
+    return static_cast<std::int16_t>(delta == 270 ? -90 : delta);
+}
+
+class Navigation;
+class ContractionHierarchy;
+
+/**
+ * @brief Distances and paths to several targets, from
+ * `Navigation::find_paths()`.
+ *
+ * The search records each reachable target's path as CSR edge indices;
+ * `Edge`s are only materialized by `path()`. The result refers to the graph
+ * that produced it, which must outlive it.
+ */
+class TargetPaths {
+  public:
+    /// Returns the number of targets, in the order they were requested.
+    std::size_t size() const { return targets.size(); }
+
+    /// Returns the name of a target.
+    const std::string &target(std::size_t index) const {
+        return targets.at(index);
+    }
+
+    /// Returns true if a path to the target was found.
+    bool reachable(std::size_t index) const {
+        return offsets.at(index) != offsets.at(index + 1);
+    }
+
+    /// Returns the length of the shortest path, or infinity if unreachable.
+    float distance(std::size_t index) const { return distances.at(index); }
+
+    /// Reconstructs the shortest path to a target.
+    std::optional<std::vector<Edge>> path(std::size_t index) const;
+
+    /// Writes the shortest path to a target into `path`, reusing its
+    /// elements; returns false and clears `path` if unreachable.
+    bool path(std::size_t index, std::vector<Edge> &path) const;
+
+    /// Returns the CSR edge indices of the path to a target, first edge
+    /// first; empty if unreachable.
+    std::span<const std::uint32_t> edge_ids(std::size_t index) const {
+        return {edges.data() + offsets.at(index),
+                offsets.at(index + 1) - offsets.at(index)};
+    }
+
+  private:
+    friend class Navigation;
+
+    const Navigation *navigation = nullptr;
+    std::vector<std::string> targets;
+    std::vector<float> distances;
+    /// Path `i` is `edges[offsets[i] .. offsets[i + 1])`, first edge first
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> edges;
+};
+
+/**
+ * @brief The closest of several targets, from `Navigation::find_nearest()`.
+ */
+struct NearestTarget {
+    std::size_t index; ///< Position of the target in the requested list
+    std::string target;
+    float distance;
+    std::vector<Edge> path;
+};
+
+/**
+ * @brief One query of `Navigation::find_path_batch()`.
+ */
+struct PathQuery {
+    NodeId from;
+    NodeId to;
+    const NodeMask *blacklist = nullptr; ///< Nodes to avoid; null for none
+};
+
+/**
+ * @brief Answer to a `PathQuery`.
+ */
+struct PathResult {
+    bool found = false;
+    EdgePath path;
+};
+
+/**
+ * @brief Node description for `Navigation::build()`.
+ */
+struct NodeSpec {
+    std::string name;
+    NodeType type;
+    std::optional<Position> position;
+};
+
+/**
+ * @brief Edge description for `Navigation::build()`, with the same meaning
+ * as the arguments of `Navigation::add_edge()`.
+ */
+struct EdgeSpec {
+    std::string from;
+    std::string to;
+    float weight;
+    Direction direction;
+};
+
 /**
  * @brief Navigation system for declarative path planning.
+ *
+ * The graph is built with `add_node()`/`add_edge()`. Once the field is fully
+ * described, `freeze()` compiles it into a compressed sparse row layout keyed
+ * by dense `NodeId`s; all queries then run on that layout, while the string
+ * API remains a thin lookup on top.
+ *
+ * A frozen graph can be written to a binary map file with `save()` and
+ * memory-mapped back with `load()`, skipping graph construction at startup.
  */
 class Navigation {
   public:
     /**
      * @brief Adds a new node to the graph with specified type.
+     *        Throws if the graph is frozen.
      * @param node Node identifier
      * @param type NodeType (PRIMARY or SECONDARY)
      */
     void add_node(const std::string &node, NodeType type);
 
+    /**
+     * @brief Adds a new node with field coordinates, used by A* heuristics.
+     * @param node Node identifier
+     * @param type NodeType (PRIMARY or SECONDARY)
+     * @param position Field coordinates of the node
+     */
+    void add_node(const std::string &node, NodeType type, Position position);
+
     /**
      * @brief Adds a directed edge between two nodes.
-     *        Throws if either node is undefined or if node type constraints are
-     * violated.
+     *        Throws if either node is undefined, if `from == to`, if the
+     * nodes are already connected, or if node type constraints are violated.
      *
      * @param from Source node
      * @param to Target node
@@ -72,6 +323,189 @@ class Navigation {
     void add_edge(const std::string &from, const std::string &to, float weight,
                   Direction direction);
 
+    /**
+     * @brief Builds a frozen graph from all of its nodes and edges at once.
+     *
+     * Produces the same graph as calling `add_node()` for every node, then
+     * `add_edge()` for every edge in order, then `freeze()`, but reserves all
+     * storage up front, lays out the CSR rows directly and computes the
+     * intersection flags in a single pass. Throws under the same conditions
+     * as `add_node()` and `add_edge()`.
+     *
+     * @param nodes All nodes of the field
+     * @param edges All edges of the field, in insertion order
+     */
+    static Navigation build(const std::vector<NodeSpec> &nodes,
+                            const std::vector<EdgeSpec> &edges);
+
+    /**
+     * @brief Compiles the graph into its frozen CSR layout.
+     *
+     * After freezing, the graph can no longer be modified; `add_node()` and
+     * `add_edge()` throw `std::logic_error`. Freezing twice is a no-op.
+     */
+    void freeze();
+
+    /**
+     * @brief Returns true once `freeze()` has been called.
+     */
+    bool is_frozen() const;
+
+    /**
+     * @brief Writes the frozen graph to a binary map file.
+     *
+     * The file holds the CSR layout, the intersection flags, the interned
+     * node names with a hash index, and the all-pairs path cache if one has
+     * been built. It is written next to `path` and renamed into place, so
+     * processes mapping an older version are unaffected. Integers are stored
+     * in host byte order. Throws `std::logic_error` if the graph is not
+     * frozen and `std::system_error` or `std::runtime_error` on I/O errors.
+     *
+     * @param path Destination file
+     */
+    void save(const std::string &path) const;
+
+    /**
+     * @brief Maps a map file written by `save()` as a frozen graph.
+     *
+     * The file is mapped read-only and used in place: loading validates the
+     * header and section bounds but neither parses nor copies the graph, and
+     * processes loading the same file share its pages. Map files are
+     * trusted; their contents beyond the header are not checked. Throws
+     * `std::system_error` if the file cannot be mapped and
+     * `std::runtime_error` if it is not a valid map.
+     *
+     * @param path Map file
+     * @param lru_capacity Blacklist LRU size used if the file carries a path
+     * cache (see `build_path_cache()`)
+     */
+    static Navigation load(const std::string &path,
+                           std::size_t lru_capacity = 64);
+
+    /**
+     * @brief Returns the dense ID of a node if known.
+     */
+    std::optional<NodeId> node_id(const std::string &node) const;
+
+    /**
+     * @brief Returns the name of a node by its dense ID.
+     */
+    std::string_view node_name(NodeId id) const;
+
+    /**
+     * @brief Returns the number of nodes in the graph.
+     */
+    std::size_t node_count() const;
+
+    /**
+     * @brief Returns the number of directed edges in the frozen graph.
+     */
+    std::size_t edge_count() const { return csr_edges.size(); }
+
+    /**
+     * @brief Index of the first out-edge of `node` in the frozen layout.
+     *
+     * The out-edges of `node` are the CSR indices in
+     * `[edges_begin(node), edges_end(node))`.
+     */
+    std::uint32_t edges_begin(NodeId node) const { return row_offsets[node]; }
+
+    /**
+     * @brief One past the index of the last out-edge of `node`.
+     */
+    std::uint32_t edges_end(NodeId node) const {
+        return row_offsets[node + 1];
+    }
+
+    /**
+     * @brief Returns a packed edge of the frozen layout by CSR index.
+     */
+    const CsrEdge &csr_edge(std::uint32_t index) const {
+        return csr_edges[index];
+    }
+
+    /**
+     * @brief Returns the source node of a frozen edge by CSR index.
+     */
+    NodeId edge_source(std::uint32_t index) const {
+        return edge_sources[index];
+    }
+
+    /**
+     * @brief Materializes a frozen edge by CSR index.
+     */
+    Edge edge_at(std::uint32_t index) const {
+        return to_edge(csr_edges[index]);
+    }
+
+    /**
+     * @brief Returns an empty `NodeMask` sized for this graph.
+     */
+    NodeMask node_mask() const;
+
+    /**
+     * @brief Precomputes all-pairs shortest paths for the frozen graph.
+     *
+     * Runs one full search per node and stores an N×N distance and
+     * predecessor table (8 bytes per node pair), so queries with an empty
+     * blacklist are answered in O(path length). Queries with a non-empty
+     * blacklist still search, but their results are memoized in a small LRU
+     * keyed on (from, to, blacklist) holding up to `lru_capacity` entries.
+     *
+     * Intended for field-sized graphs (up to a few hundred nodes). Throws
+     * `std::logic_error` if the graph is not frozen.
+     *
+     * @param lru_capacity Maximum number of memoized blacklisted queries
+     */
+    void build_path_cache(std::size_t lru_capacity = 64);
+
+    /**
+     * @brief Returns true if an all-pairs path cache has been built.
+     */
+    bool has_path_cache() const;
+
+    /**
+     * @brief Preprocesses the frozen graph into a contraction hierarchy.
+     *
+     * Afterwards, queries with an empty blacklist that the path cache and
+     * the prefetcher cannot answer search the hierarchy (see
+     * `ContractionHierarchy`), which settles only a few hundred nodes even
+     * on graphs of tens of thousands. Queries with a non-empty blacklist
+     * still run the selected `SearchStrategy`, since the hierarchy's
+     * shortcuts may pass through blacklisted nodes. Intended for large
+     * graphs that the path cache does not fit; copies of the graph share
+     * the hierarchy, but `save()` does not store it. Throws
+     * `std::logic_error` if the graph is not frozen.
+     */
+    void build_contraction_hierarchy();
+
+    /**
+     * @brief Returns true if a contraction hierarchy has been built.
+     */
+    bool has_contraction_hierarchy() const;
+
+    /**
+     * @brief Selects the search behind `find_path()` and its variants.
+     *
+     * `BIDIRECTIONAL` searches from both endpoints at once and stops when
+     * the frontiers meet, which settles about half as many nodes on long
+     * routes. It relies on every edge having a reverse edge of equal
+     * weight, as `add_edge()` guarantees. Both strategies honor the
+     * blacklist and find a shortest path, but may pick different ones
+     * among equally short paths. Applies to `find_path()`,
+     * `find_edge_path()`, `find_path_from()` and `prefetch()` on a frozen
+     * graph; the other queries always use Dijkstra. Defaults to
+     * `DIJKSTRA`.
+     */
+    void set_search_strategy(SearchStrategy strategy) {
+        search_mode = strategy;
+    }
+
+    /**
+     * @brief Returns the strategy set with `set_search_strategy()`.
+     */
+    SearchStrategy search_strategy() const { return search_mode; }
+
     /**
      * @brief Finds a shortest path from current node to a target node.
      */
@@ -79,6 +513,238 @@ class Navigation {
     find_path(const std::string &to,
               const std::unordered_set<std::string> &blacklist = {}) const;
 
+    /**
+     * @brief Finds a shortest path using caller-provided search memory.
+     *
+     * Identical to `find_path()`, but the search runs in `workspace`, and the
+     * result is written into `path`, reusing its existing elements. Once both
+     * have grown to size, replanning on a frozen graph performs no heap
+     * allocations.
+     *
+     * @return true if a path was found; `path` is left empty otherwise.
+     */
+    bool find_path(const std::string &to,
+                   const std::unordered_set<std::string> &blacklist,
+                   PathWorkspace &workspace, std::vector<Edge> &path) const;
+
+    /**
+     * @brief Finds a shortest path avoiding the nodes set in `blacklist`.
+     *
+     * The mask is probed directly by node ID inside the search, so no
+     * hashing happens per edge. Requires a frozen graph.
+     */
+    std::optional<std::vector<Edge>> find_path(const std::string &to,
+                                               const NodeMask &blacklist) const;
+
+    /**
+     * @brief `NodeMask` variant of the workspace overload of `find_path()`.
+     */
+    bool find_path(const std::string &to, const NodeMask &blacklist,
+                   PathWorkspace &workspace, std::vector<Edge> &path) const;
+
+    /**
+     * @brief Finds a shortest path as edge indices, without copying edges.
+     *
+     * Answers like `find_path()` with an empty blacklist, including from
+     * the path cache and prefetched routes, but writes CSR edge indices and
+     * the path's distance into `path`. Never allocates once `path` has grown
+     * to size. Returns false and clears `path` if there is no path.
+     * Requires a frozen graph.
+     */
+    bool find_edge_path(const std::string &to, EdgePath &path) const;
+
+    /**
+     * @brief `NodeMask` variant of `find_edge_path()`.
+     */
+    bool find_edge_path(const std::string &to, const NodeMask &blacklist,
+                        EdgePath &path) const;
+
+    /**
+     * @brief Finds a shortest path between two given nodes.
+     *
+     * Unlike `find_path()`, ignores the current node, so any number of
+     * threads may plan on one graph, e.g. to score candidate task orders.
+     * Returns nullopt if either node is unknown or there is no path.
+     * Requires a frozen graph.
+     */
+    std::optional<std::vector<Edge>> find_path_from(
+        const std::string &from, const std::string &to,
+        const std::unordered_set<std::string> &blacklist = {}) const;
+
+    /**
+     * @brief Finds a shortest path between two node IDs as edge indices.
+     *
+     * The allocation-free form of `find_path_from()`, answered like
+     * `find_edge_path()`. Returns false and clears `path` for unknown IDs
+     * or if there is no path.
+     */
+    bool find_path_from(NodeId from, NodeId to, EdgePath &path) const;
+
+    /**
+     * @brief `NodeMask` variant of the ID overload of `find_path_from()`.
+     */
+    bool find_path_from(NodeId from, NodeId to, const NodeMask &blacklist,
+                        EdgePath &path) const;
+
+    /**
+     * @brief Answers many path queries in parallel.
+     *
+     * The queries are spread over the workers of `pool`, which steal from
+     * one another when their share runs out; each worker searches in its
+     * own workspace, so throughput scales with the number of cores.
+     * `results` is resized to match `queries`, reusing its paths. Requires
+     * a frozen graph.
+     *
+     * @param queries Paths to find
+     * @param results Answer of each query, in order
+     * @param pool Threads to search on
+     */
+    void find_path_batch(const std::vector<PathQuery> &queries,
+                         std::vector<PathResult> &results,
+                         ThreadPool &pool) const;
+
+    /**
+     * @brief Materializes an `EdgePath` into `Edge`s, reusing the elements
+     * of `edges`.
+     */
+    void materialize(const EdgePath &path, std::vector<Edge> &edges) const;
+
+    /**
+     * @brief Finds a shortest path with A*, guided by node coordinates.
+     *
+     * `Heuristic` is a functor `float(const Position &, const Position &)`
+     * estimating the remaining cost between two nodes; it must be admissible
+     * and consistent for the result to be a shortest path. Nodes without
+     * coordinates are estimated at zero. Requires a frozen graph.
+     */
+    template <typename Heuristic = EuclideanHeuristic>
+    std::optional<std::vector<Edge>>
+    find_path_astar(const std::string &to,
+                    const std::unordered_set<std::string> &blacklist = {},
+                    Heuristic heuristic = {}) const;
+
+    /**
+     * @brief A* variant of the workspace overload of `find_path()`.
+     */
+    template <typename Heuristic = EuclideanHeuristic>
+    bool find_path_astar(const std::string &to,
+                         const std::unordered_set<std::string> &blacklist,
+                         PathWorkspace &workspace, std::vector<Edge> &path,
+                         Heuristic heuristic = {}) const;
+
+    /**
+     * @brief Finds shortest paths from the current node to several targets.
+     *
+     * Runs a single Dijkstra search that stops as soon as every target is
+     * settled. As with `find_path()`, the current node itself and
+     * blacklisted targets are unreachable; unknown targets are unreachable
+     * too. Requires a frozen graph.
+     *
+     * @param targets Target nodes; results are indexed in this order
+     * @param blacklist Nodes that may not be used
+     */
+    TargetPaths
+    find_paths(const std::vector<std::string> &targets,
+               const std::unordered_set<std::string> &blacklist = {}) const;
+
+    /**
+     * @brief Finds the target closest to the current node.
+     *
+     * Like `find_paths()`, but stops at the first target the search
+     * settles. Ties are broken arbitrarily. Returns nullopt if no target
+     * is reachable. Requires a frozen graph.
+     */
+    std::optional<NearestTarget>
+    find_nearest(const std::vector<std::string> &targets,
+                 const std::unordered_set<std::string> &blacklist = {}) const;
+
+    /**
+     * @brief Finds a fastest path, counting turns at the nodes on the way.
+     *
+     * Searches over (node, heading) states, i.e. over the CSR edge used to
+     * reach each node, so that the cost of every heading change along the
+     * path is known (see `TurnCosts`). With all costs zero this returns a
+     * shortest path, like `find_path()`. Requires a frozen graph.
+     *
+     * @param to Target node
+     * @param costs Turn penalties and straight-through bonus
+     * @param blacklist Nodes that may not be used
+     * @param heading Direction the robot faces at its current node; if
+     * given, the first edge is charged for turning away from it
+     */
+    std::optional<std::vector<Edge>>
+    find_path_turns(const std::string &to, const TurnCosts &costs,
+                    const std::unordered_set<std::string> &blacklist = {},
+                    std::optional<Direction> heading = std::nullopt) const;
+
+    /**
+     * @brief Turn-aware variant of the workspace overload of `find_path()`.
+     *
+     * The workspace is sized by edges rather than nodes.
+     */
+    bool find_path_turns(const std::string &to, const TurnCosts &costs,
+                         const std::unordered_set<std::string> &blacklist,
+                         PathWorkspace &workspace, std::vector<Edge> &path,
+                         std::optional<Direction> heading = std::nullopt) const;
+
+    /**
+     * @brief `NodeMask` variant of the workspace overload of
+     * `find_path_turns()`.
+     */
+    bool find_path_turns(const std::string &to, const TurnCosts &costs,
+                         const NodeMask &blacklist, PathWorkspace &workspace,
+                         std::vector<Edge> &path,
+                         std::optional<Direction> heading = std::nullopt) const;
+
+    /**
+     * @brief Returns the compiled motion plan of the shortest path from the
+     * current node to `to`.
+     *
+     * Plans are memoized per (from, to), so each route is searched and
+     * compiled once; copies of a frozen graph share the memo, which is
+     * thread-safe. Returns nullptr where `find_path()` finds no path.
+     * Requires a frozen graph.
+     */
+    std::shared_ptr<const MotionPlan> motion_plan(const std::string &to) const;
+
+    /**
+     * @brief Compiles a path, e.g. one found with a blacklist, into drive
+     * and turn commands.
+     *
+     * Collinear edges collapse into one `DRIVE`, and every change of
+     * direction becomes a `TURN`. Edges to unknown nodes get `NO_NODE`.
+     */
+    MotionPlan compile_motion(const std::vector<Edge> &path) const;
+
+    /**
+     * @brief `EdgePath` variant of `compile_motion()`.
+     */
+    MotionPlan compile_motion(const EdgePath &path) const;
+
+    /**
+     * @brief Plans the routes from `from` to each of `targets` on a
+     * background thread.
+     *
+     * Meant to be called with the node a robot is driving to and the
+     * targets of the tasks likely to run next (see
+     * `Lifecycle::predicted_targets()`). Once the robot arrives there, a
+     * `find_path()` with an empty blacklist to a prefetched target takes the
+     * finished route instead of searching. Each call replaces the previous
+     * predictions; routes not yet planned, or planned but never taken, are
+     * dropped. Unknown nodes are ignored. Requires a frozen graph; copies of
+     * it share the background thread, which is started on first use.
+     *
+     * @param from Node the routes start at
+     * @param targets Nodes to plan routes to
+     */
+    void prefetch(const std::string &from,
+                  const std::vector<std::string> &targets) const;
+
+    /**
+     * @brief Returns the coordinates of a node if it has any.
+     */
+    std::optional<Position> get_node_position(const std::string &node) const;
+
     /**
      * @brief Sets the robot’s current node.
      */
@@ -103,11 +769,284 @@ class Navigation {
     std::optional<Edge> get_edge(const std::string &from,
                                  const std::string &to) const;
 
+    /**
+     * @brief Returns the CSR index of the edge from one node to another,
+     * for use with `csr_edge()`. Requires a frozen graph.
+     */
+    std::optional<std::uint32_t> edge_id(std::string_view from,
+                                         std::string_view to) const;
+
   private:
+    // Graph under construction; released by `freeze()`
     std::unordered_map<std::string, std::vector<Edge>> adjacency_list;
     std::unordered_map<std::string, NodeType> node_types;
 
+    /// Interned node names; a node's ID is its index in this vector
+    std::vector<std::string> node_names;
+    std::unordered_map<std::string, NodeId> node_ids;
+    /// Coordinates by node ID; NaN for nodes added without a position
+    std::vector<Position> node_positions;
+
+    /// Maps (from << 32 | to) to the edge's position in
+    /// `adjacency_list[from]`
+    std::unordered_map<std::uint64_t, std::uint32_t> edge_index;
+
+    /// Frozen graph, including node names and lookup tables; owned in
+    /// memory or mapped from a map file, and shared between copies
+    struct Layout;
+    std::shared_ptr<const Layout> layout;
+
+    /// Views into `layout` used by the searches: out-edges of node `n` are
+    /// `csr_edges[row_offsets[n] .. row_offsets[n + 1])`
+    ArrayView<std::uint32_t> row_offsets;
+    ArrayView<CsrEdge> csr_edges;
+    ArrayView<NodeId> edge_sources; ///< Source node of each CSR edge
+    ArrayView<Position> positions;  ///< Coordinates, NaN when unknown
+
+    /// All-pairs table plus blacklist LRU; shared between copies of a frozen
+    /// graph since its contents depend only on the (immutable) layout
+    struct PathCache;
+    std::shared_ptr<PathCache> path_cache;
+
+    /// Built by `build_contraction_hierarchy()`; immutable once built, and
+    /// shared between copies
+    std::shared_ptr<const ContractionHierarchy> hierarchy;
+
+    /// Memoized motion plans per (from, to); created by `attach()` and,
+    /// like the layout, shared between copies
+    struct MotionCache;
+    std::shared_ptr<MotionCache> motion_cache;
+
+    /// Background planner behind `prefetch()`; created by `attach()` and
+    /// shared between copies
+    struct Prefetcher;
+    std::shared_ptr<Prefetcher> prefetcher;
+
+    /// Switches to the frozen layout and releases the construction state.
+    void attach(std::shared_ptr<const Layout> compiled);
+
+    std::optional<std::vector<Edge>>
+    find_path_dynamic(const std::string &to,
+                      const std::unordered_set<std::string> &blacklist) const;
+
+    /// Returns the start time of a path query for `end_query()`; 0 if
+    /// neither tracing nor metrics need it.
+    static std::uint64_t begin_query();
+
+    /// Records a finished path query in the trace buffer and the metrics
+    /// registry, if installed.
+    static void end_query(std::uint64_t start, bool found,
+                          std::size_t expanded);
+
+    /// Throws `std::logic_error` naming `operation` unless frozen.
+    void require_frozen(const char *operation) const;
+
+    /// Resolves the current node and `to` to IDs; false if either is unknown.
+    bool resolve_endpoints(const std::string &to, NodeId &from,
+                           NodeId &target) const;
+
+    /// Marks every known blacklisted node in `workspace`, optionally
+    /// collecting the resolved IDs into `ids`.
+    void block_nodes(const std::unordered_set<std::string> &blacklist,
+                     PathWorkspace &workspace, std::vector<NodeId> *ids) const;
+
+    /// Runs Dijkstra over the CSR layout; blocked nodes are pre-marked in
+    /// `workspace`. Returns true if `to` was reached. With `to == NO_NODE`
+    /// the search settles every reachable node.
+    bool search(NodeId from, NodeId to, PathWorkspace &workspace) const;
+
+    /// Point-to-point search with the selected `SearchStrategy`; nodes are
+    /// blocked by `blacklist`, or by the marks in `workspace` if null. On
+    /// success the path's CSR edges are in `workspace.path_edges()`, last
+    /// first.
+    bool search_route(NodeId from, NodeId to, const NodeMask *blacklist,
+                      PathWorkspace &workspace) const;
+
+    /// Bidirectional Dijkstra behind `search_route()`; the backward search
+    /// runs in a thread-local workspace, and `workspace` counts the
+    /// expansions of both.
+    template <typename Blocked>
+    bool bidirectional_search(NodeId from, NodeId to, PathWorkspace &workspace,
+                              Blocked is_blocked) const;
+
+    /// Returns the CSR index of the edge running opposite to `edge`.
+    std::uint32_t reverse_edge(std::uint32_t edge) const;
+
+    /// Best-first search shared by Dijkstra and A*. `estimate(node)` returns
+    /// a consistent lower bound on the remaining cost from `node` to `to`;
+    /// `is_blocked(node)` returns true for nodes that may not be used.
+    template <typename Estimate, typename Blocked>
+    bool best_first_search(NodeId from, NodeId to, PathWorkspace &workspace,
+                           Estimate estimate, Blocked is_blocked) const;
+
+    /// Core of `best_first_search()`: expands nodes until `stop(node)`
+    /// returns true for a node popped off the queue, or the queue runs dry.
+    /// `stop` also sees (later) stale entries of already settled nodes.
+    template <typename Estimate, typename Blocked, typename Stop>
+    void expand_until(NodeId from, PathWorkspace &workspace, Estimate estimate,
+                      Blocked is_blocked, Stop stop) const;
+
+    /// Resolves `targets` into `ids` (`NO_NODE` if unknown) and marks those
+    /// that can be reached in `pending`; returns how many are marked.
+    std::size_t mark_targets(const std::vector<std::string> &targets,
+                             NodeId from, const PathWorkspace &workspace,
+                             std::vector<NodeId> &ids,
+                             NodeMask &pending) const;
+
+    /// Dijkstra over arrival-edge states for `find_path_turns()`; on success
+    /// the path's CSR edges are in `workspace.path_edges()`, last first.
+    bool turn_search(NodeId from, NodeId to, const TurnCosts &costs,
+                     std::optional<Direction> heading, const NodeMask &blocked,
+                     PathWorkspace &workspace) const;
+
+    /// Frozen-graph bodies of the workspace overloads of `find_path()`
+    bool plan_path(const std::string &to,
+                   const std::unordered_set<std::string> &blacklist,
+                   PathWorkspace &workspace, std::vector<Edge> &path) const;
+    bool plan_path(const std::string &to, const NodeMask &blacklist,
+                   PathWorkspace &workspace, std::vector<Edge> &path) const;
+
+    /// Plans a route with an empty blacklist: from the path cache, a
+    /// prefetched route, the contraction hierarchy or a search. On success
+    /// the path's CSR edges are in `workspace.path_edges()`, last first.
+    /// A `stateless` query (`find_path_from()`, `find_path_batch()`) copies
+    /// a prefetched route instead of taking it from the robot's next query.
+    bool plan_route(NodeId from, NodeId to, PathWorkspace &workspace,
+                    bool stateless) const;
+
+    /// `NodeMask` variant of `plan_route()`.
+    bool plan_route(NodeId from, NodeId to, const NodeMask &blacklist,
+                    PathWorkspace &workspace, bool stateless) const;
+
+    /// Reads an empty-blacklist route from the path cache into
+    /// `workspace.path_edges()`, last edge first.
+    bool cached_route(NodeId from, NodeId to, PathWorkspace &workspace) const;
+
+    /// Body of the `find_edge_path()` overloads; null `blacklist` is empty.
+    bool plan_edge_path(const std::string &to, const NodeMask *blacklist,
+                        EdgePath &path) const;
+
+    /// Plans between two node IDs into `path`; null `blacklist` is empty.
+    /// `stateless` is passed on to `plan_route()`.
+    bool plan_between(NodeId from, NodeId to, const NodeMask *blacklist,
+                      PathWorkspace &workspace, EdgePath &path,
+                      bool stateless) const;
+
+    /// Plans between two node IDs avoiding the nodes named in `blacklist`;
+    /// `workspace` must have been begun.
+    bool plan_between(NodeId from, NodeId to,
+                      const std::unordered_set<std::string> &blacklist,
+                      PathWorkspace &workspace, std::vector<Edge> &path,
+                      bool stateless) const;
+
+    /// Writes a route left in `workspace.path_edges()` into `path`.
+    void emit_edge_path(const std::vector<std::uint32_t> &reversed,
+                        EdgePath &path) const;
+
+    /// Collects the CSR edges of the path ending at `to` found by `search()`
+    /// into `workspace.path_edges()`, last edge first.
+    void reconstruct(NodeId from, NodeId to, PathWorkspace &workspace) const;
+
+    /// Materializes reversed CSR edge indices into `path`.
+    void emit_path(const std::vector<std::uint32_t> &reversed,
+                   std::vector<Edge> &path) const;
+
+    Edge to_edge(const CsrEdge &edge) const;
+    void assign_edge(Edge &out, const CsrEdge &edge) const;
+
     std::optional<std::string> current_node;
+    SearchStrategy search_mode = SearchStrategy::DIJKSTRA;
 };
 
+template <typename Estimate, typename Blocked>
+bool Navigation::best_first_search(NodeId from, NodeId to,
+                                   PathWorkspace &workspace, Estimate estimate,
+                                   Blocked is_blocked) const {
+    expand_until(from, workspace, estimate, is_blocked,
+                 [to](NodeId node) { return node == to; });
+    if (to == NO_NODE)
+        return true;
+    return workspace.parent_edge(to) != PathWorkspace::NO_EDGE;
+}
+
+template <typename Estimate, typename Blocked, typename Stop>
+void Navigation::expand_until(NodeId from, PathWorkspace &workspace,
+                              Estimate estimate, Blocked is_blocked,
+                              Stop stop) const {
+    workspace.set(from, 0.0f, PathWorkspace::NO_EDGE);
+    workspace.push(estimate(from), from);
+
+    PathWorkspace::HeapEntry top;
+    while (workspace.pop(top)) {
+        const NodeId u = top.node;
+        if (stop(u))
+            break;
+
+        const float g = workspace.distance(u);
+        if (top.key > g + estimate(u) || is_blocked(u))
+            continue; // Stale heap entry or blacklisted node
+        workspace.count_expansion();
+
+        for (std::uint32_t e = row_offsets[u]; e < row_offsets[u + 1]; ++e) {
+            const CsrEdge &edge = csr_edges[e];
+            if (is_blocked(edge.to))
+                continue;
+
+            float alt = g + edge.weight;
+            if (alt < workspace.distance(edge.to)) {
+                workspace.set(edge.to, alt, e);
+                workspace.push(alt + estimate(edge.to), edge.to);
+            }
+        }
+    }
+}
+
+template <typename Heuristic>
+std::optional<std::vector<Edge>>
+Navigation::find_path_astar(const std::string &to,
+                            const std::unordered_set<std::string> &blacklist,
+                            Heuristic heuristic) const {
+    thread_local PathWorkspace workspace;
+    std::vector<Edge> path;
+    if (!find_path_astar(to, blacklist, workspace, path, heuristic))
+        return std::nullopt;
+    return path;
+}
+
+template <typename Heuristic>
+bool Navigation::find_path_astar(
+    const std::string &to, const std::unordered_set<std::string> &blacklist,
+    PathWorkspace &workspace, std::vector<Edge> &path,
+    Heuristic heuristic) const {
+    require_frozen("A* search");
+    const std::uint64_t query_start = begin_query();
+    workspace.begin(node_count());
+    path.clear();
+
+    NodeId from, target;
+    if (!resolve_endpoints(to, from, target)) {
+        end_query(query_start, false, 0);
+        return false;
+    }
+    block_nodes(blacklist, workspace, nullptr);
+
+    const Position goal = positions[target];
+    auto estimate = [&](NodeId node) {
+        const Position &p = positions[node];
+        if (std::isnan(p.x) || std::isnan(goal.x))
+            return 0.0f;
+        return heuristic(p, goal);
+    };
+
+    auto is_blocked = [&](NodeId node) { return workspace.blocked(node); };
+    bool found =
+        best_first_search(from, target, workspace, estimate, is_blocked);
+    end_query(query_start, found, workspace.expanded_nodes());
+    if (!found)
+        return false;
+    reconstruct(from, target, workspace);
+    emit_path(workspace.path_edges(), path);
+    return true;
+}
+
 } // namespace choros
@@ -0,0 +1,180 @@
+#pragma once
+
+// Internal to the navigation translation units: the frozen graph layout and
+// its map file format.
+
+#include "navigation.hpp"
+#include <list>
+#include <mutex>
+#include <string_view>
+
+namespace choros {
+
+/// Sections of a map image, in file order
+enum MapSection : std::uint32_t {
+    MAP_ROW_OFFSETS,  ///< node_count + 1 `uint32_t`
+    MAP_EDGES,        ///< edge_count `CsrEdge`
+    MAP_EDGE_SOURCES, ///< edge_count `NodeId`
+    MAP_POSITIONS,    ///< node_count `Position`, NaN when unknown
+    MAP_TYPES,        ///< node_count `uint8_t` `NodeType`
+    MAP_NAME_OFFSETS, ///< node_count + 1 `uint32_t` offsets into the names
+    MAP_NAMES,        ///< Concatenated node names, without terminators
+    MAP_NODE_SLOTS,   ///< Open-addressing table from name hash to `NodeId`
+    MAP_EDGE_SLOTS,   ///< Open-addressing table from (from, to) to CSR index
+    MAP_CACHE_DIST,   ///< Optional node_count² all-pairs distances
+    MAP_CACHE_PARENT, ///< Optional node_count² all-pairs parent edges
+    MAP_SECTION_COUNT
+};
+
+constexpr char MAP_MAGIC[4] = {'C', 'H', 'M', 'P'};
+constexpr std::uint32_t MAP_VERSION = 1;
+/// Written in host byte order; reads back differently on a foreign host
+constexpr std::uint32_t MAP_BYTE_ORDER = 0x01020304;
+/// `MapHeader::flags` bit set when the all-pairs cache sections are present
+constexpr std::uint32_t MAP_HAS_PATH_CACHE = 1;
+
+/**
+ * @brief Header at the start of a map image.
+ *
+ * Section offsets are in bytes from the start of the image and aligned to
+ * 8 bytes, so every section can be used in place once the image is mapped.
+ */
+struct MapHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t flags;
+    std::uint32_t node_count;
+    std::uint32_t edge_count;
+    std::uint32_t node_slots; ///< Power of two
+    std::uint32_t edge_slots; ///< Power of two
+    std::uint64_t name_bytes;
+    std::uint64_t file_size;
+    std::uint64_t sections[MAP_SECTION_COUNT];
+};
+
+/**
+ * @brief Immutable frozen graph.
+ *
+ * Every array is a view into one map image, held either in memory (after
+ * `freeze()` or `build()`) or mapped read-only from a map file (after
+ * `load()`). Name and edge lookups probe hash tables stored in the image, so
+ * a mapped layout needs no per-node allocations.
+ */
+struct Navigation::Layout {
+    std::uint32_t node_count = 0;
+    ArrayView<std::uint32_t> row_offsets;
+    ArrayView<CsrEdge> edges;
+    ArrayView<NodeId> edge_sources;
+    ArrayView<Position> positions;
+    ArrayView<std::uint8_t> types;
+    ArrayView<std::uint32_t> name_offsets;
+    ArrayView<char> names;
+    ArrayView<NodeId> node_slots;
+    ArrayView<std::uint32_t> edge_slots;
+
+    /// Start of the image; its graph sections end at `image_size`
+    const MapHeader *header = nullptr;
+    std::size_t image_size = 0;
+
+    /// Backing memory: an owned image, or a mapping of a map file
+    std::vector<std::uint64_t> storage;
+    std::shared_ptr<const void> mapping;
+
+    /**
+     * @brief Lays out a frozen graph as an in-memory map image.
+     */
+    static std::shared_ptr<const Layout>
+    compile(const std::vector<std::string_view> &node_names,
+            const std::vector<NodeType> &node_types,
+            const std::vector<Position> &node_positions,
+            const std::vector<std::uint32_t> &row_offsets,
+            const std::vector<CsrEdge> &edges,
+            const std::vector<NodeId> &edge_sources);
+
+    /// Points the views at the sections of the image at `base`.
+    void bind(const unsigned char *base);
+
+    std::optional<NodeId> find_node(std::string_view name) const;
+    std::string_view name(NodeId node) const;
+    NodeType type(NodeId node) const;
+    /// Returns the CSR index of from ➜ to, or `PathWorkspace::NO_EDGE`.
+    std::uint32_t find_edge(NodeId from, NodeId to) const;
+};
+
+struct Navigation::PathCache {
+    std::size_t node_count = 0;
+    /// Row-major [from * node_count + to] shortest distances
+    ArrayView<float> dist;
+    /// Row-major CSR index of the last edge on each from ➜ to path
+    ArrayView<std::uint32_t> parent;
+
+    /// Backing memory of the tables: owned by `build_path_cache()`, or the
+    /// mapping of the map file they were loaded from
+    std::vector<float> dist_storage;
+    std::vector<std::uint32_t> parent_storage;
+    std::shared_ptr<const void> mapping;
+
+    struct Entry {
+        std::uint64_t hash;
+        NodeId from;
+        NodeId to;
+        std::vector<NodeId> blocked; ///< Sorted blacklisted node IDs
+        bool found;
+        std::vector<std::uint32_t> reversed; ///< Path edges, last first
+    };
+
+    /// Most recently used entry first; small enough that a linear scan on
+    /// the hash beats a secondary index
+    std::list<Entry> lru;
+    std::size_t lru_capacity = 0;
+    std::mutex mutex;
+
+    static std::uint64_t hash_key(NodeId from, NodeId to,
+                                  const std::vector<NodeId> &blocked) {
+        std::uint64_t h = (static_cast<std::uint64_t>(from) << 32) ^ to;
+        for (NodeId id : blocked) {
+            h ^= id + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        }
+        return h;
+    }
+
+    /// Copies a memoized result into `reversed`; returns nullopt on a miss.
+    std::optional<bool> lookup(std::uint64_t hash, NodeId from, NodeId to,
+                               const std::vector<NodeId> &blocked,
+                               std::vector<std::uint32_t> &reversed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = lru.begin(); it != lru.end(); ++it) {
+            if (it->hash != hash || it->from != from || it->to != to ||
+                it->blocked != blocked)
+                continue;
+            lru.splice(lru.begin(), lru, it);
+            reversed.assign(it->reversed.begin(), it->reversed.end());
+            return it->found;
+        }
+        return std::nullopt;
+    }
+
+    void insert(std::uint64_t hash, NodeId from, NodeId to,
+                const std::vector<NodeId> &blocked, bool found,
+                const std::vector<std::uint32_t> &reversed) {
+        if (lru_capacity == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lru.size() < lru_capacity)
+            lru.emplace_front();
+        else
+            lru.splice(lru.begin(), lru, std::prev(lru.end())); // Evict LRU
+
+        // Reuse the evicted entry's buffers
+        Entry &entry = lru.front();
+        entry.hash = hash;
+        entry.from = from;
+        entry.to = to;
+        entry.blocked.assign(blocked.begin(), blocked.end());
+        entry.found = found;
+        entry.reversed.assign(reversed.begin(), reversed.end());
+    }
+};
+
+} // namespace choros
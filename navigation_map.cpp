@@ -0,0 +1,377 @@
+#include "navigation_layout.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace choros {
+
+namespace {
+
+static_assert(sizeof(MapHeader) % 8 == 0, "Sections must stay aligned");
+static_assert(sizeof(CsrEdge) == 16 && sizeof(Position) == 8,
+              "The map format depends on the packed record sizes");
+
+constexpr std::uint64_t align8(std::uint64_t bytes) {
+    return (bytes + 7) & ~std::uint64_t{7};
+}
+
+/// Smallest power of two holding `entries` at a load factor of at most 1/2
+std::uint32_t table_size(std::size_t entries) {
+    std::uint32_t slots = 2;
+    while (slots < 2 * entries)
+        slots *= 2;
+    return slots;
+}
+
+/// FNV-1a
+std::uint64_t hash_name(std::string_view name) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/// splitmix64 finalizer over the (from, to) pair
+std::uint64_t hash_edge(NodeId from, NodeId to) {
+    std::uint64_t h = (static_cast<std::uint64_t>(from) << 32) | to;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+std::uint64_t section_bytes(const MapHeader &header, MapSection section) {
+    const std::uint64_t n = header.node_count, m = header.edge_count;
+    const bool cached = header.flags & MAP_HAS_PATH_CACHE;
+    switch (section) {
+    case MAP_ROW_OFFSETS:
+    case MAP_NAME_OFFSETS:
+        return (n + 1) * sizeof(std::uint32_t);
+    case MAP_EDGES:
+        return m * sizeof(CsrEdge);
+    case MAP_EDGE_SOURCES:
+        return m * sizeof(NodeId);
+    case MAP_POSITIONS:
+        return n * sizeof(Position);
+    case MAP_TYPES:
+        return n;
+    case MAP_NAMES:
+        return header.name_bytes;
+    case MAP_NODE_SLOTS:
+        return std::uint64_t{header.node_slots} * sizeof(NodeId);
+    case MAP_EDGE_SLOTS:
+        return std::uint64_t{header.edge_slots} * sizeof(std::uint32_t);
+    case MAP_CACHE_DIST:
+        return cached ? n * n * sizeof(float) : 0;
+    case MAP_CACHE_PARENT:
+        return cached ? n * n * sizeof(std::uint32_t) : 0;
+    case MAP_SECTION_COUNT:
+        break;
+    }
+    return 0;
+}
+
+/// Assigns consecutive, aligned offsets to every section and the file size.
+void place_sections(MapHeader &header) {
+    std::uint64_t offset = sizeof(MapHeader);
+    for (std::uint32_t s = 0; s < MAP_SECTION_COUNT; ++s) {
+        header.sections[s] = offset;
+        offset = align8(offset + section_bytes(header, MapSection(s)));
+    }
+    header.file_size = offset;
+}
+
+bool is_power_of_two(std::uint32_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+/// Checks everything `Layout::bind()` relies on without touching sections.
+void validate(const MapHeader &header, std::size_t size,
+              const std::string &path) {
+    auto fail = [&](const char *reason) {
+        throw std::runtime_error("Invalid map file " + path + ": " + reason);
+    };
+    if (std::memcmp(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0)
+        fail("not a choros map");
+    if (header.version != MAP_VERSION)
+        fail("unsupported version");
+    if (header.byte_order != MAP_BYTE_ORDER)
+        fail("written on a host with a different byte order");
+    if (!is_power_of_two(header.node_slots) ||
+        header.node_slots <= header.node_count ||
+        !is_power_of_two(header.edge_slots) ||
+        header.edge_slots <= header.edge_count)
+        fail("malformed lookup tables");
+    if ((header.flags & MAP_HAS_PATH_CACHE) && header.node_count > 0xffff)
+        fail("path cache too large");
+
+    MapHeader expected = header;
+    place_sections(expected);
+    if (std::memcmp(expected.sections, header.sections,
+                    sizeof(header.sections)) != 0 ||
+        header.file_size != size || expected.file_size != size)
+        fail("truncated or corrupt");
+}
+
+/// Pads `out` with zeros up to `offset`.
+void pad_to(std::ostream &out, std::uint64_t &written, std::uint64_t offset) {
+    static const char zeros[8] = {};
+    out.write(zeros, static_cast<std::streamsize>(offset - written));
+    written = offset;
+}
+
+template <typename T>
+void write_array(std::ostream &out, std::uint64_t &written,
+                 ArrayView<T> data) {
+    const std::uint64_t bytes = data.size() * sizeof(T);
+    out.write(reinterpret_cast<const char *>(data.data()),
+              static_cast<std::streamsize>(bytes));
+    written += bytes;
+}
+
+} // namespace
+
+std::shared_ptr<const Navigation::Layout>
+Navigation::Layout::compile(const std::vector<std::string_view> &node_names,
+                            const std::vector<NodeType> &node_types,
+                            const std::vector<Position> &node_positions,
+                            const std::vector<std::uint32_t> &row_offsets,
+                            const std::vector<CsrEdge> &edges,
+                            const std::vector<NodeId> &edge_sources) {
+    const std::size_t n = node_names.size(), m = edges.size();
+    MapHeader header{};
+    std::memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+    header.version = MAP_VERSION;
+    header.byte_order = MAP_BYTE_ORDER;
+    header.node_count = static_cast<std::uint32_t>(n);
+    header.edge_count = static_cast<std::uint32_t>(m);
+    header.node_slots = table_size(n);
+    header.edge_slots = table_size(m);
+    for (std::string_view name : node_names)
+        header.name_bytes += name.size();
+    place_sections(header);
+
+    auto layout = std::make_shared<Layout>();
+    layout->storage.assign(header.file_size / 8, 0);
+    auto *base = reinterpret_cast<unsigned char *>(layout->storage.data());
+    auto section = [&](MapSection s) { return base + header.sections[s]; };
+    std::memcpy(base, &header, sizeof(header));
+
+    std::copy(row_offsets.begin(), row_offsets.end(),
+              reinterpret_cast<std::uint32_t *>(section(MAP_ROW_OFFSETS)));
+    std::copy(edge_sources.begin(), edge_sources.end(),
+              reinterpret_cast<NodeId *>(section(MAP_EDGE_SOURCES)));
+    std::copy(node_positions.begin(), node_positions.end(),
+              reinterpret_cast<Position *>(section(MAP_POSITIONS)));
+
+    // Field by field, so the padding stays zero and saved maps are stable
+    auto *csr = reinterpret_cast<CsrEdge *>(section(MAP_EDGES));
+    for (std::size_t e = 0; e < m; ++e) {
+        csr[e].to = edges[e].to;
+        csr[e].weight = edges[e].weight;
+        csr[e].direction = edges[e].direction;
+        csr[e].intersections = edges[e].intersections;
+    }
+
+    auto *types = section(MAP_TYPES);
+    auto *name_offsets =
+        reinterpret_cast<std::uint32_t *>(section(MAP_NAME_OFFSETS));
+    auto *names = reinterpret_cast<char *>(section(MAP_NAMES));
+    std::uint32_t offset = 0;
+    for (std::size_t id = 0; id < n; ++id) {
+        types[id] = static_cast<std::uint8_t>(node_types[id]);
+        name_offsets[id] = offset;
+        std::memcpy(names + offset, node_names[id].data(),
+                    node_names[id].size());
+        offset += static_cast<std::uint32_t>(node_names[id].size());
+    }
+    name_offsets[n] = offset;
+
+    // Empty slots are all ones, i.e. NO_NODE and NO_EDGE
+    auto *node_slots = reinterpret_cast<NodeId *>(section(MAP_NODE_SLOTS));
+    std::memset(node_slots, 0xff, header.node_slots * sizeof(NodeId));
+    for (NodeId id = 0; id < n; ++id) {
+        std::uint64_t slot = hash_name(node_names[id]);
+        while (node_slots[slot & (header.node_slots - 1)] != NO_NODE)
+            ++slot;
+        node_slots[slot & (header.node_slots - 1)] = id;
+    }
+    auto *edge_slots =
+        reinterpret_cast<std::uint32_t *>(section(MAP_EDGE_SLOTS));
+    std::memset(edge_slots, 0xff, header.edge_slots * sizeof(std::uint32_t));
+    for (std::uint32_t e = 0; e < m; ++e) {
+        std::uint64_t slot = hash_edge(edge_sources[e], edges[e].to);
+        while (edge_slots[slot & (header.edge_slots - 1)] !=
+               PathWorkspace::NO_EDGE)
+            ++slot;
+        edge_slots[slot & (header.edge_slots - 1)] = e;
+    }
+
+    layout->bind(base);
+    return layout;
+}
+
+void Navigation::Layout::bind(const unsigned char *base) {
+    header = reinterpret_cast<const MapHeader *>(base);
+    node_count = header->node_count;
+    const std::size_t n = header->node_count, m = header->edge_count;
+    auto at = [&](MapSection s) { return base + header->sections[s]; };
+
+    row_offsets = {reinterpret_cast<const std::uint32_t *>(at(MAP_ROW_OFFSETS)),
+                   n + 1};
+    edges = {reinterpret_cast<const CsrEdge *>(at(MAP_EDGES)), m};
+    edge_sources = {reinterpret_cast<const NodeId *>(at(MAP_EDGE_SOURCES)), m};
+    positions = {reinterpret_cast<const Position *>(at(MAP_POSITIONS)), n};
+    types = {at(MAP_TYPES), n};
+    name_offsets = {
+        reinterpret_cast<const std::uint32_t *>(at(MAP_NAME_OFFSETS)), n + 1};
+    names = {reinterpret_cast<const char *>(at(MAP_NAMES)),
+             static_cast<std::size_t>(header->name_bytes)};
+    node_slots = {reinterpret_cast<const NodeId *>(at(MAP_NODE_SLOTS)),
+                  header->node_slots};
+    edge_slots = {reinterpret_cast<const std::uint32_t *>(at(MAP_EDGE_SLOTS)),
+                  header->edge_slots};
+    image_size = header->sections[MAP_CACHE_DIST];
+}
+
+std::optional<NodeId>
+Navigation::Layout::find_node(std::string_view node) const {
+    const std::uint64_t mask = node_slots.size() - 1;
+    for (std::uint64_t slot = hash_name(node);; ++slot) {
+        const NodeId id = node_slots[slot & mask];
+        if (id == NO_NODE)
+            return std::nullopt;
+        if (name(id) == node)
+            return id;
+    }
+}
+
+std::string_view Navigation::Layout::name(NodeId node) const {
+    return {names.data() + name_offsets[node],
+            name_offsets[node + 1] - name_offsets[node]};
+}
+
+NodeType Navigation::Layout::type(NodeId node) const {
+    return static_cast<NodeType>(types[node]);
+}
+
+std::uint32_t Navigation::Layout::find_edge(NodeId from, NodeId to) const {
+    const std::uint64_t mask = edge_slots.size() - 1;
+    for (std::uint64_t slot = hash_edge(from, to);; ++slot) {
+        const std::uint32_t e = edge_slots[slot & mask];
+        if (e == PathWorkspace::NO_EDGE ||
+            (edge_sources[e] == from && edges[e].to == to))
+            return e;
+    }
+}
+
+void Navigation::save(const std::string &path) const {
+    require_frozen("Saving a map");
+
+    MapHeader header = *layout->header;
+    header.flags = path_cache ? MAP_HAS_PATH_CACHE : 0;
+    place_sections(header);
+
+    // Write beside the target and rename, so processes that still map the
+    // old file keep a consistent view
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw std::system_error(errno, std::generic_category(),
+                                    "Cannot write map " + temporary);
+        std::uint64_t written = 0;
+        write_array(out, written, ArrayView<MapHeader>(&header, 1));
+        const auto *image = reinterpret_cast<const char *>(layout->header);
+        out.write(image + written,
+                  static_cast<std::streamsize>(layout->image_size - written));
+        written = layout->image_size;
+        if (path_cache) {
+            pad_to(out, written, header.sections[MAP_CACHE_DIST]);
+            write_array(out, written, path_cache->dist);
+            pad_to(out, written, header.sections[MAP_CACHE_PARENT]);
+            write_array(out, written, path_cache->parent);
+        }
+        pad_to(out, written, header.file_size);
+        out.flush();
+        if (!out)
+            throw std::runtime_error("Failed writing map " + temporary);
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot replace map " + path);
+}
+
+Navigation Navigation::load(const std::string &path,
+                            std::size_t lru_capacity) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot open map " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "Cannot stat map " + path);
+    }
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    if (size < sizeof(MapHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Invalid map file " + path +
+                                 ": not a choros map");
+    }
+
+    // Read-only shared mapping: processes loading the same map share pages
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(),
+                                "Cannot map " + path);
+    std::shared_ptr<const void> mapping(data, [size](const void *p) {
+        ::munmap(const_cast<void *>(p), size);
+    });
+
+    const auto *base = static_cast<const unsigned char *>(data);
+    const MapHeader &header = *reinterpret_cast<const MapHeader *>(base);
+    validate(header, size, path);
+
+    auto layout = std::make_shared<Layout>();
+    layout->mapping = mapping;
+    layout->bind(base);
+    if (layout->row_offsets[header.node_count] != header.edge_count ||
+        layout->name_offsets[header.node_count] != header.name_bytes)
+        throw std::runtime_error("Invalid map file " + path +
+                                 ": truncated or corrupt");
+
+    Navigation navigation;
+    navigation.attach(std::move(layout));
+    if (header.flags & MAP_HAS_PATH_CACHE) {
+        const std::size_t cells =
+            std::size_t{header.node_count} * header.node_count;
+        auto cache = std::make_shared<PathCache>();
+        cache->node_count = header.node_count;
+        cache->dist = {reinterpret_cast<const float *>(
+                           base + header.sections[MAP_CACHE_DIST]),
+                       cells};
+        cache->parent = {reinterpret_cast<const std::uint32_t *>(
+                             base + header.sections[MAP_CACHE_PARENT]),
+                         cells};
+        cache->mapping = std::move(mapping);
+        cache->lru_capacity = lru_capacity;
+        navigation.path_cache = std::move(cache);
+    }
+    return navigation;
+}
+
+} // namespace choros
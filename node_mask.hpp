@@ -0,0 +1,81 @@
+#pragma once
+
+#include "path_workspace.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Compact dynamic bitset over node IDs.
+ *
+ * Used as a blacklist by the `NodeMask` overloads of
+ * `Navigation::find_path()`, replacing string hashing in the search loop with
+ * a single bit test. A mask can be kept across ticks and refilled with
+ * `clear()`/`set()` without allocating. IDs beyond `size()` read as unset.
+ */
+class NodeMask {
+  public:
+    /**
+     * @brief Creates an empty mask able to hold `node_count` nodes.
+     *
+     * There is deliberately no default constructor, so `find_path(to, {})`
+     * keeps selecting the `std::unordered_set` overload.
+     */
+    explicit NodeMask(std::size_t node_count) { resize(node_count); }
+
+    /**
+     * @brief Resizes the mask; newly added bits are unset.
+     */
+    void resize(std::size_t node_count) {
+        words.resize((node_count + 63) / 64, 0);
+        if (node_count < bits && node_count % 64 != 0)
+            words.back() &= (std::uint64_t{1} << (node_count % 64)) - 1;
+        bits = node_count;
+    }
+
+    /// Returns the number of nodes the mask can hold.
+    std::size_t size() const { return bits; }
+
+    /// Marks `node` as blocked.
+    void set(NodeId node) {
+        words[node / 64] |= std::uint64_t{1} << (node % 64);
+    }
+
+    /// Marks `node` as passable.
+    void reset(NodeId node) {
+        words[node / 64] &= ~(std::uint64_t{1} << (node % 64));
+    }
+
+    /// Returns true if `node` is blocked.
+    bool test(NodeId node) const {
+        return node < bits && (words[node / 64] >> (node % 64)) & 1u;
+    }
+
+    /// Unblocks every node without releasing memory.
+    void clear() {
+        for (auto &word : words)
+            word = 0;
+    }
+
+    /// Returns true if no node is blocked.
+    bool none() const {
+        for (auto word : words) {
+            if (word != 0)
+                return false;
+        }
+        return true;
+    }
+
+    /// Raw 64-bit words, least significant bit first.
+    const std::uint64_t *data() const { return words.data(); }
+
+    /// Number of 64-bit words in `data()`.
+    std::size_t word_count() const { return words.size(); }
+
+  private:
+    std::vector<std::uint64_t> words;
+    std::size_t bits = 0;
+};
+
+} // namespace choros
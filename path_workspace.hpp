@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace choros {
+
+/// Dense integer identifier assigned to each node when it is added.
+using NodeId = std::uint32_t;
+
+/// Marker for "no node", e.g. a search without a single target.
+constexpr NodeId NO_NODE = std::numeric_limits<NodeId>::max();
+
+/**
+ * @brief Reusable scratch memory for graph searches.
+ *
+ * A workspace holds per-node distance and parent arrays plus a binary heap.
+ * Instead of clearing those arrays before every search, each entry carries a
+ * generation stamp; `begin()` bumps the generation in O(1), and entries whose
+ * stamp is stale read as untouched. Once a workspace has grown to the size of
+ * the graph, searches through it perform no heap allocations.
+ *
+ * A workspace may be reused across searches and graphs but must not be shared
+ * between threads concurrently.
+ */
+class PathWorkspace {
+  public:
+    /// Marker for "no parent edge"
+    static constexpr std::uint32_t NO_EDGE =
+        std::numeric_limits<std::uint32_t>::max();
+
+    /// Heap entry ordered by tentative distance
+    struct HeapEntry {
+        float key = 0.0f;
+        NodeId node = NO_NODE;
+
+        bool operator>(const HeapEntry &other) const {
+            return key > other.key;
+        }
+    };
+
+    PathWorkspace() = default;
+
+    /**
+     * @brief Creates a workspace preallocated for `node_count` nodes.
+     */
+    explicit PathWorkspace(std::size_t node_count) { reserve(node_count); }
+
+    /**
+     * @brief Grows the per-node arrays and the heap to fit `node_count` nodes.
+     */
+    void reserve(std::size_t node_count) {
+        if (stamp.size() < node_count) {
+            dist.resize(node_count);
+            parent.resize(node_count);
+            stamp.resize(node_count, 0);
+            blocked_stamp.resize(node_count, 0);
+        }
+        heap.reserve(node_count);
+        path_buffer.reserve(node_count);
+    }
+
+    /**
+     * @brief Starts a new search over a graph of `node_count` nodes.
+     *
+     * Invalidates all distances, parents and blocked marks in O(1).
+     */
+    void begin(std::size_t node_count) {
+        reserve(node_count);
+        heap.clear();
+        expanded = 0;
+        if (++generation == 0) {
+            // Stamps wrapped around; fall back to a full clear once
+            std::fill(stamp.begin(), stamp.end(), 0);
+            std::fill(blocked_stamp.begin(), blocked_stamp.end(), 0);
+            generation = 1;
+        }
+    }
+
+    /// Returns true if `node` received a tentative distance in this search.
+    bool touched(NodeId node) const { return stamp[node] == generation; }
+
+    /// Returns the tentative distance of `node` (infinity if untouched).
+    float distance(NodeId node) const {
+        return touched(node) ? dist[node]
+                             : std::numeric_limits<float>::infinity();
+    }
+
+    /// Returns the CSR index of the edge used to reach `node`, or `NO_EDGE`.
+    std::uint32_t parent_edge(NodeId node) const {
+        return touched(node) ? parent[node] : NO_EDGE;
+    }
+
+    /// Records a tentative distance and parent edge for `node`.
+    void set(NodeId node, float distance, std::uint32_t edge) {
+        stamp[node] = generation;
+        dist[node] = distance;
+        parent[node] = edge;
+    }
+
+    /// Marks `node` as blocked for the current search.
+    void block(NodeId node) { blocked_stamp[node] = generation; }
+
+    /// Returns true if `node` was blocked in the current search.
+    bool blocked(NodeId node) const {
+        return blocked_stamp[node] == generation;
+    }
+
+    /// Pushes a heap entry.
+    void push(float key, NodeId node) {
+        heap.push_back({key, node});
+        std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    }
+
+    /// Pops the entry with the smallest key; returns false if empty.
+    bool pop(HeapEntry &out) {
+        if (heap.empty())
+            return false;
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        out = heap.back();
+        heap.pop_back();
+        return true;
+    }
+
+    /// Returns the smallest key in the heap, or infinity if it is empty.
+    float min_key() const {
+        return heap.empty() ? std::numeric_limits<float>::infinity()
+                            : heap.front().key;
+    }
+
+    /// Counts one node expansion.
+    void count_expansion() { ++expanded; }
+
+    /// Returns how many nodes the current search has expanded.
+    std::size_t expanded_nodes() const { return expanded; }
+
+    /// Scratch buffer for path reconstruction (edge indices).
+    std::vector<std::uint32_t> &path_edges() { return path_buffer; }
+
+  private:
+    std::vector<float> dist;
+    std::vector<std::uint32_t> parent;
+    std::vector<std::uint32_t> stamp;
+    std::vector<std::uint32_t> blocked_stamp;
+    std::uint32_t generation = 0;
+    std::size_t expanded = 0;
+
+    std::vector<HeapEntry> heap;
+    std::vector<std::uint32_t> path_buffer;
+};
+
+} // namespace choros
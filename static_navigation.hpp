@@ -0,0 +1,343 @@
+#pragma once
+
+#include "navigation.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Node description for `StaticNavigation`.
+ */
+struct StaticNodeSpec {
+    std::string_view name;
+    NodeType type = NodeType::PRIMARY;
+    Position position{std::numeric_limits<float>::quiet_NaN(),
+                      std::numeric_limits<float>::quiet_NaN()};
+};
+
+/**
+ * @brief Edge description for `StaticNavigation`, with the same meaning as
+ * the arguments of `Navigation::add_edge()`.
+ */
+struct StaticEdgeSpec {
+    std::string_view from;
+    std::string_view to;
+    float weight;
+    Direction direction;
+};
+
+/**
+ * @brief A path found by `StaticNavigation::find_path()`.
+ *
+ * Holds CSR edge indices inline, so it needs no allocation and can be the
+ * result of a constant expression. Empty if no path was found.
+ */
+template <std::size_t N> struct StaticPath {
+    std::array<std::uint32_t, N == 0 ? 1 : N> edges{};
+    std::size_t length = 0;
+    float distance = 0.0f;
+
+    constexpr std::size_t size() const { return length; }
+    constexpr bool empty() const { return length == 0; }
+    constexpr std::uint32_t operator[](std::size_t index) const {
+        return edges[index];
+    }
+    constexpr const std::uint32_t *begin() const { return edges.data(); }
+    constexpr const std::uint32_t *end() const {
+        return edges.data() + length;
+    }
+};
+
+/**
+ * @brief A field graph laid out at compile time.
+ *
+ * For fields that are fixed for a season: the constructor builds the same
+ * CSR layout as `Navigation::build()` (rows in insertion order, both
+ * directions of every edge, the same intersection flags) into `std::array`s,
+ * so a `constexpr` instance costs no construction and no allocation at
+ * startup. `find_path()` is `constexpr` too, so fixed routes can be checked
+ * or precomputed by the compiler:
+ *
+ * @code
+ * constexpr StaticNavigation field(
+ *     std::array{StaticNodeSpec{"start"}, StaticNodeSpec{"cube"}},
+ *     std::array{StaticEdgeSpec{"start", "cube", 30, Direction::NORTH}});
+ * constexpr auto route = field.find_path("start", "cube");
+ * static_assert(route.size() == 1);
+ * @endcode
+ *
+ * Invalid specs throw the same exceptions as `Navigation::build()`, which
+ * makes constant evaluation fail. For blacklists and the other query types,
+ * `to_navigation()` builds an equivalent runtime graph.
+ *
+ * @tparam N Number of nodes
+ * @tparam M Number of edge specs; the layout holds `2 * M` directed edges
+ */
+template <std::size_t N, std::size_t M> class StaticNavigation {
+  public:
+    constexpr StaticNavigation(const std::array<StaticNodeSpec, N> &nodes,
+                               const std::array<StaticEdgeSpec, M> &edges) {
+        for (std::size_t i = 0; i < N; ++i) {
+            names[i] = nodes[i].name;
+            types[i] = nodes[i].type;
+            positions[i] = nodes[i].position;
+            by_name[i] = static_cast<NodeId>(i);
+        }
+        std::sort(by_name.begin(), by_name.end(), [&](NodeId a, NodeId b) {
+            return names[a] < names[b];
+        });
+        for (std::size_t i = 1; i < N; ++i) {
+            if (names[by_name[i - 1]] == names[by_name[i]])
+                throw std::invalid_argument(
+                    "Node already exists: " + std::string(names[by_name[i]]));
+        }
+
+        // Resolve and validate every edge, then counting sort into rows
+        std::array<NodeId, M == 0 ? 1 : M> from_ids{}, to_ids{};
+        std::array<std::uint32_t, N + 1> degree{};
+        for (std::size_t i = 0; i < M; ++i) {
+            const auto from = node_id(edges[i].from);
+            const auto to = node_id(edges[i].to);
+            if (!from.has_value() || !to.has_value())
+                throw std::invalid_argument(
+                    "Both nodes must be added before adding an edge.");
+            if (*from == *to)
+                throw std::invalid_argument("Edge cannot connect '" +
+                                            std::string(edges[i].from) +
+                                            "' to itself.");
+            for (std::size_t j = 0; j < i; ++j) {
+                if ((from_ids[j] == *from && to_ids[j] == *to) ||
+                    (from_ids[j] == *to && to_ids[j] == *from))
+                    throw std::logic_error(
+                        "Edge already exists: " + std::string(edges[i].from) +
+                        " -> " + std::string(edges[i].to));
+            }
+            for (NodeId id : {*from, *to}) {
+                if (++degree[id] > 1 && types[id] == NodeType::SECONDARY)
+                    throw std::logic_error("Secondary node '" +
+                                           std::string(names[id]) +
+                                           "' may only have one edge.");
+            }
+            from_ids[i] = *from;
+            to_ids[i] = *to;
+        }
+        for (std::size_t id = 0; id < N; ++id)
+            row_offsets[id + 1] = row_offsets[id] + degree[id];
+
+        std::array<std::uint32_t, 2 * M == 0 ? 1 : 2 * M> twin{};
+        std::array<bool, 2 * M == 0 ? 1 : 2 * M> outgoing{};
+        std::array<std::uint32_t, N + 1> cursor = row_offsets;
+        for (std::size_t i = 0; i < M; ++i) {
+            const NodeId from = from_ids[i], to = to_ids[i];
+            const std::uint32_t forward = cursor[from]++;
+            const std::uint32_t backward = cursor[to]++;
+            csr_edges[forward] = {to, edges[i].weight, edges[i].direction, 0};
+            csr_edges[backward] = {from, edges[i].weight,
+                                   reverse_of(edges[i].direction), 0};
+            edge_sources[forward] = from;
+            edge_sources[backward] = to;
+            twin[forward] = backward;
+            twin[backward] = forward;
+            outgoing[forward] = true;
+            spec_edges[i] = forward;
+        }
+
+        // Intersection flags, walked exactly as in Navigation::build()
+        for (std::size_t node = 0; node < N; ++node) {
+            std::uint8_t seen = 0;
+            for (std::uint32_t e = row_offsets[node + 1];
+                 e-- > row_offsets[node];) {
+                if (outgoing[e])
+                    seen |= direction_bit(csr_edges[e].direction);
+                CsrEdge &into = csr_edges[twin[e]];
+                into.intersections |= seen & perpendicular(into.direction);
+            }
+        }
+    }
+
+    /// Returns the number of nodes.
+    static constexpr std::size_t node_count() { return N; }
+
+    /// Returns the number of directed edges.
+    static constexpr std::size_t edge_count() { return 2 * M; }
+
+    /// Returns the ID of a node, or nullopt if it is unknown.
+    constexpr std::optional<NodeId> node_id(std::string_view name) const {
+        auto it = std::lower_bound(
+            by_name.begin(), by_name.end(), name,
+            [&](NodeId id, std::string_view key) { return names[id] < key; });
+        if (it == by_name.end() || names[*it] != name)
+            return std::nullopt;
+        return *it;
+    }
+
+    constexpr std::string_view node_name(NodeId id) const { return names[id]; }
+    constexpr NodeType node_type(NodeId id) const { return types[id]; }
+    constexpr Position node_position(NodeId id) const {
+        return positions[id];
+    }
+
+    /// CSR index of the first outgoing edge of `node`.
+    constexpr std::uint32_t edges_begin(NodeId node) const {
+        return row_offsets[node];
+    }
+
+    /// CSR index one past the last outgoing edge of `node`.
+    constexpr std::uint32_t edges_end(NodeId node) const {
+        return row_offsets[node + 1];
+    }
+
+    constexpr const CsrEdge &csr_edge(std::uint32_t index) const {
+        return csr_edges[index];
+    }
+
+    constexpr NodeId edge_source(std::uint32_t index) const {
+        return edge_sources[index];
+    }
+
+    /**
+     * @brief Finds a shortest path between two nodes.
+     *
+     * Dijkstra over the inline arrays, selecting the closest open node by a
+     * linear scan (O(N²), no heap), which suits field-sized graphs and
+     * constant evaluation. As with `Navigation::find_path()`, a path from a
+     * node to itself is empty.
+     */
+    constexpr StaticPath<N> find_path(NodeId from, NodeId to) const {
+        constexpr float INF = std::numeric_limits<float>::infinity();
+        std::array<float, N == 0 ? 1 : N> dist{};
+        std::array<std::uint32_t, N == 0 ? 1 : N> parent{};
+        std::array<bool, N == 0 ? 1 : N> done{};
+        for (std::size_t i = 0; i < N; ++i) {
+            dist[i] = INF;
+            parent[i] = PathWorkspace::NO_EDGE;
+        }
+
+        StaticPath<N> path;
+        if (from >= N || to >= N || from == to)
+            return path;
+        dist[from] = 0.0f;
+        while (true) {
+            NodeId node = NO_NODE;
+            for (NodeId i = 0; i < N; ++i) {
+                if (!done[i] && dist[i] < INF &&
+                    (node == NO_NODE || dist[i] < dist[node]))
+                    node = i;
+            }
+            if (node == NO_NODE)
+                return path;
+            if (node == to)
+                break;
+            done[node] = true;
+            for (std::uint32_t e = row_offsets[node]; e < row_offsets[node + 1];
+                 ++e) {
+                const CsrEdge &edge = csr_edges[e];
+                const float alt = dist[node] + edge.weight;
+                if (alt < dist[edge.to]) {
+                    dist[edge.to] = alt;
+                    parent[edge.to] = e;
+                }
+            }
+        }
+
+        for (NodeId node = to; node != from; node = edge_sources[parent[node]])
+            path.edges[path.length++] = parent[node];
+        std::reverse(path.edges.begin(), path.edges.begin() + path.length);
+        path.distance = dist[to];
+        return path;
+    }
+
+    /// String variant of `find_path()`; unknown nodes give an empty path.
+    constexpr StaticPath<N> find_path(std::string_view from,
+                                      std::string_view to) const {
+        const auto source = node_id(from);
+        const auto target = node_id(to);
+        if (!source.has_value() || !target.has_value())
+            return {};
+        return find_path(*source, *target);
+    }
+
+    /// Materializes a CSR edge as an `Edge`.
+    Edge edge_at(std::uint32_t index) const {
+        const CsrEdge &edge = csr_edges[index];
+        Edge out{std::string(names[edge.to]), edge.weight, edge.direction};
+        out.intersection_east =
+            edge.intersections & direction_bit(Direction::EAST);
+        out.intersection_north =
+            edge.intersections & direction_bit(Direction::NORTH);
+        out.intersection_west =
+            edge.intersections & direction_bit(Direction::WEST);
+        out.intersection_south =
+            edge.intersections & direction_bit(Direction::SOUTH);
+        return out;
+    }
+
+    /// Materializes a path as `Edge`s, like `Navigation::find_path()`.
+    std::vector<Edge> edges(const StaticPath<N> &path) const {
+        std::vector<Edge> out;
+        out.reserve(path.size());
+        for (std::uint32_t e : path)
+            out.push_back(edge_at(e));
+        return out;
+    }
+
+    /**
+     * @brief Builds an equivalent frozen `Navigation` at runtime.
+     *
+     * Node IDs and CSR indices are the same in both graphs.
+     */
+    Navigation to_navigation() const {
+        std::vector<NodeSpec> nodes;
+        nodes.reserve(N);
+        for (std::size_t i = 0; i < N; ++i)
+            nodes.push_back({std::string(names[i]), types[i], positions[i]});
+        std::vector<EdgeSpec> specs;
+        specs.reserve(M);
+        for (std::uint32_t e : spec_edges) {
+            const CsrEdge &edge = csr_edges[e];
+            specs.push_back({std::string(names[edge_sources[e]]),
+                             std::string(names[edge.to]), edge.weight,
+                             edge.direction});
+        }
+        return Navigation::build(nodes, specs);
+    }
+
+  private:
+    std::array<std::string_view, N> names{};
+    std::array<NodeType, N> types{};
+    std::array<Position, N> positions{};
+    /// Node IDs sorted by name, for `node_id()`
+    std::array<NodeId, N> by_name{};
+    std::array<std::uint32_t, N + 1> row_offsets{};
+    std::array<CsrEdge, 2 * M> csr_edges{};
+    std::array<NodeId, 2 * M> edge_sources{};
+    /// Spec order of the forward edges, for `to_navigation()`
+    std::array<std::uint32_t, M> spec_edges{};
+
+    static constexpr std::uint8_t direction_bit(Direction direction) {
+        return static_cast<std::uint8_t>(1u << (static_cast<int>(direction) /
+                                                 90));
+    }
+
+    static constexpr Direction reverse_of(Direction direction) {
+        return static_cast<Direction>((static_cast<int>(direction) + 180) %
+                                      360);
+    }
+
+    static constexpr std::uint8_t perpendicular(Direction direction) {
+        return direction == Direction::EAST || direction == Direction::WEST
+                   ? direction_bit(Direction::NORTH) |
+                         direction_bit(Direction::SOUTH)
+                   : direction_bit(Direction::EAST) |
+                         direction_bit(Direction::WEST);
+    }
+};
+
+} // namespace choros
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "lifecycle.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace choros {
+
+/**
+ * @brief Dependency description for `StaticTaskGraph`: `to` depends on
+ * `from`, as with `Lifecycle::add_dependency()`.
+ */
+struct StaticDependency {
+    std::string_view from;
+    std::string_view to;
+};
+
+/**
+ * @brief A task DAG compiled at compile time.
+ *
+ * For task graphs that are fixed for a season: the constructor assigns
+ * handles in declaration order, lays the dependents out as CSR and
+ * precomputes a topological order, all in `std::array`s, so a `constexpr`
+ * instance costs no construction and no allocation at startup. A cycle or
+ * an unknown task throws like `Lifecycle::compile_tasks()`, which makes
+ * constant evaluation fail:
+ *
+ * @code
+ * constexpr StaticTaskGraph plan(
+ *     std::array<std::string_view, 3>{"drive", "grab", "score"},
+ *     std::array{StaticDependency{"drive", "grab"},
+ *                StaticDependency{"grab", "score"}});
+ * static_assert(plan.order()[2] == *plan.task_handle("score"));
+ * @endcode
+ *
+ * The graph either runs directly with `execute()`, or is handed to a
+ * `Lifecycle` with `install()` for priorities, resources and parallelism.
+ *
+ * @tparam N Number of tasks
+ * @tparam D Number of dependencies
+ */
+template <std::size_t N, std::size_t D> class StaticTaskGraph {
+  public:
+    /// Attempts per task `execute()` makes unless told otherwise
+    static constexpr std::size_t DEFAULT_MAX_ATTEMPTS = 10;
+
+    constexpr StaticTaskGraph(const std::array<std::string_view, N> &task_ids,
+                              const std::array<StaticDependency, D> &deps)
+        : ids(task_ids) {
+        for (std::size_t i = 0; i < N; ++i)
+            by_id[i] = static_cast<TaskHandle>(i);
+        std::sort(by_id.begin(), by_id.end(), [&](TaskHandle a, TaskHandle b) {
+            return ids[a] < ids[b];
+        });
+        for (std::size_t i = 1; i < N; ++i) {
+            if (ids[by_id[i - 1]] == ids[by_id[i]])
+                throw std::invalid_argument("Task already exists: " +
+                                            std::string(ids[by_id[i]]));
+        }
+
+        // Counting sort of the dependencies by prerequisite into CSR form
+        std::array<TaskHandle, D == 0 ? 1 : D> from{}, to{};
+        for (std::size_t i = 0; i < D; ++i) {
+            from[i] = require_task(deps[i].from);
+            to[i] = require_task(deps[i].to);
+            ++offsets[from[i] + 1];
+            ++prerequisites[to[i]];
+        }
+        for (std::size_t t = 0; t < N; ++t)
+            offsets[t + 1] += offsets[t];
+        std::array<std::uint32_t, N + 1> cursor = offsets;
+        for (std::size_t i = 0; i < D; ++i)
+            dependents[cursor[from[i]]++] = to[i];
+
+        // Kahn's algorithm; tasks left over afterwards lie on a cycle
+        std::array<std::uint32_t, N == 0 ? 1 : N> remaining{};
+        std::size_t count = 0;
+        for (std::size_t t = 0; t < N; ++t) {
+            remaining[t] = prerequisites[t];
+            if (remaining[t] == 0)
+                topological[count++] = static_cast<TaskHandle>(t);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const TaskHandle t = topological[i];
+            for (auto e = offsets[t]; e < offsets[t + 1]; ++e) {
+                if (--remaining[dependents[e]] == 0)
+                    topological[count++] = dependents[e];
+            }
+        }
+        if (count != N) {
+            std::size_t stuck = 0;
+            while (remaining[stuck] == 0)
+                ++stuck;
+            throw std::logic_error("Task graph contains a cycle through '" +
+                                   std::string(ids[stuck]) + "'.");
+        }
+    }
+
+    /// Returns the number of tasks.
+    static constexpr std::size_t task_count() { return N; }
+
+    /// Returns the handle of a task, or nullopt if it is unknown.
+    constexpr std::optional<TaskHandle> task_handle(std::string_view id) const {
+        auto it = std::lower_bound(
+            by_id.begin(), by_id.end(), id,
+            [&](TaskHandle t, std::string_view key) { return ids[t] < key; });
+        if (it == by_id.end() || ids[*it] != id)
+            return std::nullopt;
+        return *it;
+    }
+
+    constexpr std::string_view task_id(TaskHandle task) const {
+        return ids[task];
+    }
+
+    /// Returns the tasks in a topological order.
+    constexpr const std::array<TaskHandle, N> &order() const {
+        return topological;
+    }
+
+    /// Returns the number of prerequisites of `task`.
+    constexpr std::uint32_t prerequisite_count(TaskHandle task) const {
+        return prerequisites[task];
+    }
+
+    /// Dependents of `task` are `dependent(i)` for `i` in
+    /// `[dependents_begin(task), dependents_end(task))`.
+    constexpr std::uint32_t dependents_begin(TaskHandle task) const {
+        return offsets[task];
+    }
+    constexpr std::uint32_t dependents_end(TaskHandle task) const {
+        return offsets[task + 1];
+    }
+    constexpr TaskHandle dependent(std::uint32_t index) const {
+        return dependents[index];
+    }
+
+    /**
+     * @brief Runs the tasks on the calling thread in topological order.
+     *
+     * Settles tasks like `Lifecycle::execute_tasks()`: a task runs once all
+     * its prerequisites have settled, and a task that fails (fatally or out
+     * of retries) unlocks its dependents just like one that succeeds, so
+     * both paths run the same tasks. A `RETRYABLE_FAILURE` is retried as
+     * `retry` describes, the calling thread sleeping through each backoff;
+     * by default at most `DEFAULT_MAX_ATTEMPTS` attempts are made, with the
+     * backoff of a default `RetryPolicy`. Performs no allocation.
+     *
+     * @param lifecycle Passed on to `Task::execute()`
+     * @param tasks Task of each handle
+     * @param retry How retryable failures of every task are retried
+     * @return The final state of each task
+     */
+    std::array<TaskState, N>
+    execute(Lifecycle &lifecycle, const std::array<Task *, N> &tasks,
+            const RetryPolicy &retry = {
+                .max_attempts = DEFAULT_MAX_ATTEMPTS}) const {
+        using Clock = std::chrono::steady_clock;
+        std::array<TaskState, N> states{};
+        for (TaskHandle task : topological) {
+            const auto first_attempt = Clock::now();
+            std::chrono::milliseconds backoff{0};
+            TaskResult result = tasks[task]->execute(lifecycle);
+            for (std::size_t attempts = 1;
+                 result == TaskResult::RETRYABLE_FAILURE; ++attempts) {
+                // Same schedule as `Lifecycle::finish_attempt()`
+                backoff = attempts == 1 ? retry.initial_backoff
+                                        : grown(backoff, retry);
+                const auto retry_at = Clock::now() + backoff;
+                if ((retry.max_attempts != 0 &&
+                     attempts >= retry.max_attempts) ||
+                    (retry.deadline.count() != 0 &&
+                     retry_at > first_attempt + retry.deadline))
+                    break;
+                std::this_thread::sleep_until(retry_at);
+                result = tasks[task]->execute(lifecycle);
+            }
+            states[task] = result == TaskResult::SUCCESS ? TaskState::SUCCEEDED
+                                                         : TaskState::FAILED;
+        }
+        return states;
+    }
+
+    /**
+     * @brief Adds the tasks and dependencies to a lifecycle.
+     *
+     * Tasks are added in handle order, so on an empty lifecycle their
+     * `Lifecycle` handles match the static ones.
+     *
+     * @param lifecycle Lifecycle to add the graph to
+     * @param tasks Task of each handle
+     * @param options Scheduling options of each handle
+     */
+    void install(Lifecycle &lifecycle,
+                 const std::array<std::shared_ptr<Task>, N> &tasks,
+                 const std::array<TaskOptions, N> &options = {}) const {
+        std::array<TaskHandle, N> handles{};
+        for (std::size_t t = 0; t < N; ++t)
+            handles[t] =
+                lifecycle.add_task(std::string(ids[t]), tasks[t], options[t]);
+        for (std::size_t t = 0; t < N; ++t) {
+            for (auto e = offsets[t]; e < offsets[t + 1]; ++e)
+                lifecycle.add_dependency(handles[t], handles[dependents[e]]);
+        }
+    }
+
+  private:
+    std::array<std::string_view, N> ids{};
+    /// Handles sorted by ID, for `task_handle()`
+    std::array<TaskHandle, N> by_id{};
+    std::array<std::uint32_t, N + 1> offsets{};
+    std::array<TaskHandle, D == 0 ? 1 : D> dependents{};
+    std::array<std::uint32_t, N == 0 ? 1 : N> prerequisites{};
+    std::array<TaskHandle, N> topological{};
+
+    /// Returns the wait after `backoff` before the next retry.
+    static std::chrono::milliseconds grown(std::chrono::milliseconds backoff,
+                                           const RetryPolicy &retry) {
+        return std::min(retry.max_backoff,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            backoff * retry.backoff_multiplier));
+    }
+
+    constexpr TaskHandle require_task(std::string_view id) const {
+        auto handle = task_handle(id);
+        if (!handle.has_value())
+            throw std::invalid_argument("Unknown task: " + std::string(id));
+        return *handle;
+    }
+};
+
+} // namespace choros
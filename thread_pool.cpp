@@ -0,0 +1,164 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace choros {
+
+namespace {
+
+constexpr std::uint64_t pack(std::uint64_t begin, std::uint64_t end) {
+    return begin << 32 | end;
+}
+
+constexpr std::uint64_t range_begin(std::uint64_t bounds) {
+    return bounds >> 32;
+}
+
+constexpr std::uint64_t range_end(std::uint64_t bounds) {
+    return bounds & 0xffffffffu;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t workers) {
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    ranges_count = workers;
+    ranges = std::make_unique<Range[]>(workers);
+    threads.reserve(workers - 1);
+    for (std::size_t worker = 1; worker < workers; ++worker)
+        threads.emplace_back(&ThreadPool::thread_main, this, worker);
+}
+
+ThreadPool::~ThreadPool() {
+    std::lock_guard<std::mutex> loop(loop_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void ThreadPool::parallel_for(
+    std::size_t count,
+    const std::function<void(std::size_t, std::size_t)> &body) {
+    if (count > std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("parallel_for() supports 2^32 - 1 indices.");
+    if (count == 0)
+        return;
+
+    std::lock_guard<std::mutex> loop(loop_mutex);
+    const std::size_t share = count / ranges_count;
+    const std::size_t extra = count % ranges_count;
+    std::size_t begin = 0;
+    for (std::size_t worker = 0; worker < ranges_count; ++worker) {
+        const std::size_t end = begin + share + (worker < extra ? 1 : 0);
+        ranges[worker].bounds.store(pack(begin, end),
+                                    std::memory_order_relaxed);
+        begin = end;
+    }
+    cancelled.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        error = nullptr;
+        running = threads.size();
+        ++generation;
+    }
+    start.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return running == 0; });
+    job = nullptr;
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void ThreadPool::thread_main(std::size_t worker) {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        start.wait(lock, [&] { return stop || generation != seen; });
+        if (stop)
+            return;
+        seen = generation;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if (--running == 0)
+            finished.notify_one();
+    }
+}
+
+void ThreadPool::work(std::size_t worker) {
+    const auto &body = *job;
+    std::size_t index;
+    while (!cancelled.load(std::memory_order_relaxed)) {
+        if (!take(worker, index)) {
+            if (!steal(worker))
+                return;
+            continue;
+        }
+        try {
+            body(index, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool ThreadPool::take(std::size_t worker, std::size_t &index) {
+    std::atomic<std::uint64_t> &bounds = ranges[worker].bounds;
+    std::uint64_t current = bounds.load(std::memory_order_acquire);
+    while (range_begin(current) < range_end(current)) {
+        const std::uint64_t next =
+            pack(range_begin(current) + 1, range_end(current));
+        if (bounds.compare_exchange_weak(current, next,
+                                         std::memory_order_acq_rel)) {
+            index = range_begin(current);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::steal(std::size_t worker) {
+    // Steal from the fullest range, halving it
+    while (true) {
+        std::size_t victim = worker;
+        std::uint64_t largest = 0, seen = 0;
+        for (std::size_t i = 1; i < ranges_count; ++i) {
+            const std::size_t other = (worker + i) % ranges_count;
+            const std::uint64_t bounds =
+                ranges[other].bounds.load(std::memory_order_acquire);
+            const std::uint64_t left = range_end(bounds) - range_begin(bounds);
+            if (range_begin(bounds) < range_end(bounds) && left > largest) {
+                victim = other;
+                largest = left;
+                seen = bounds;
+            }
+        }
+        if (victim == worker)
+            return false;
+
+        const std::uint64_t begin = range_begin(seen), end = range_end(seen);
+        const std::uint64_t split = begin + (end - begin) / 2;
+        if (!ranges[victim].bounds.compare_exchange_strong(
+                seen, pack(begin, split), std::memory_order_acq_rel))
+            continue;
+        // Only the owner refills its range, and it is empty while stealing
+        ranges[worker].bounds.store(pack(split, end),
+                                    std::memory_order_release);
+        return true;
+    }
+}
+
+} // namespace choros
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Fixed pool of threads running parallel loops with work stealing.
+ *
+ * `parallel_for()` splits the index range evenly between the workers, the
+ * calling thread being worker 0. Each worker takes indices from the front
+ * of its own range; once that is empty, it steals the upper half of the
+ * largest range it finds, so uneven work (e.g. path queries of very
+ * different lengths) still keeps every core busy. Used by
+ * `Navigation::find_path_batch()`; the threads are created once and reused
+ * by every loop.
+ */
+class ThreadPool {
+  public:
+    /**
+     * @brief Starts `workers - 1` threads; the caller of `parallel_for()`
+     * is the remaining worker.
+     *
+     * @param workers Number of workers; 0 means one per hardware thread
+     */
+    explicit ThreadPool(std::size_t workers = 0);
+
+    /// Waits for the running loop, if any, and stops the threads.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Returns the number of workers, including the calling thread.
+    std::size_t size() const { return ranges_count; }
+
+    /**
+     * @brief Calls `body(index, worker)` for every index below `count`.
+     *
+     * `worker` is below `size()` and identifies the thread running the
+     * call, e.g. to pick per-worker scratch memory. Blocks until all calls
+     * returned. If a call throws, the remaining indices are skipped and
+     * the first exception is rethrown. Concurrent loops run one after
+     * another. Throws `std::length_error` for more than 2^32 - 1 indices.
+     */
+    void
+    parallel_for(std::size_t count,
+                 const std::function<void(std::size_t, std::size_t)> &body);
+
+  private:
+    /// Remaining indices `[begin, end)` of a worker, packed as
+    /// `begin << 32 | end` so that owner and thieves update them with one
+    /// compare-and-swap
+    struct alignas(64) Range {
+        std::atomic<std::uint64_t> bounds{0};
+    };
+
+    std::size_t ranges_count = 1;
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> threads;
+
+    /// Serializes `parallel_for()` calls
+    std::mutex loop_mutex;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable finished;
+    const std::function<void(std::size_t, std::size_t)> *job = nullptr;
+    std::uint64_t generation = 0;
+    std::size_t running = 0;
+    bool stop = false;
+    std::atomic<bool> cancelled{false};
+    std::exception_ptr error;
+
+    void thread_main(std::size_t worker);
+    void work(std::size_t worker);
+    bool take(std::size_t worker, std::size_t &index);
+    bool steal(std::size_t worker);
+};
+
+} // namespace choros
@@ -0,0 +1,217 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace choros {
+
+namespace {
+
+std::atomic<TraceBuffer *> installed_buffer{nullptr};
+std::atomic<std::uint32_t> next_thread_index{0};
+
+std::uint32_t thread_index() {
+    thread_local const std::uint32_t index = next_thread_index.fetch_add(1);
+    return index;
+}
+
+TraceEvent make_event(TraceEventType type, const char *name) {
+    TraceEvent event;
+    event.timestamp_ns = trace_now();
+    event.name = name;
+    event.type = type;
+    return event;
+}
+
+void write_json_string(std::ostream &out, const char *text) {
+    out << '"';
+    for (const char *c = text; *c; ++c) {
+        switch (*c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20)
+                out << ' ';
+            else
+                out << *c;
+        }
+    }
+    out << '"';
+}
+
+/// Writes nanoseconds as microseconds with full precision
+void write_micros(std::ostream &out, std::uint64_t ns) {
+    const std::uint64_t fraction = ns % 1000;
+    out << ns / 1000 << '.' << fraction / 100 << (fraction / 10) % 10
+        << fraction % 10;
+}
+
+template <typename T> void write_le(std::ostream &out, T value) {
+    unsigned char bytes[sizeof(T)];
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        bytes[i] = static_cast<unsigned char>(
+            static_cast<std::uint64_t>(value) >> (8 * i));
+    out.write(reinterpret_cast<const char *>(bytes), sizeof(T));
+}
+
+} // namespace
+
+std::uint64_t trace_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+TraceEvent TraceEvent::phase_begin(const char *phase) {
+    return make_event(TraceEventType::PHASE_BEGIN, phase);
+}
+
+TraceEvent TraceEvent::phase_end(const char *phase) {
+    return make_event(TraceEventType::PHASE_END, phase);
+}
+
+TraceEvent TraceEvent::task_dispatch(const char *task, std::uint32_t attempt) {
+    TraceEvent event = make_event(TraceEventType::TASK_DISPATCH, task);
+    event.count = attempt;
+    return event;
+}
+
+TraceEvent TraceEvent::task_result(const char *task, int result,
+                                   std::uint32_t attempt) {
+    TraceEvent event = make_event(TraceEventType::TASK_RESULT, task);
+    event.value = result;
+    event.count = attempt;
+    return event;
+}
+
+TraceEvent TraceEvent::path_search(std::uint64_t start_ns, bool found,
+                                   std::size_t expanded) {
+    TraceEvent event = make_event(TraceEventType::PATH_SEARCH, "find_path");
+    event.duration_ns = event.timestamp_ns - start_ns;
+    event.timestamp_ns = start_ns;
+    event.value = found;
+    event.count = static_cast<std::uint32_t>(expanded);
+    return event;
+}
+
+TraceBuffer::TraceBuffer(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+}
+
+void TraceBuffer::record(TraceEvent event) {
+    event.thread = thread_index();
+    const std::uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceBuffer::snapshot() const {
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    const std::uint64_t capacity = mask + 1;
+    const std::uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<TraceEvent> events;
+    events.reserve(end - begin);
+    for (std::uint64_t index = begin; index < end; ++index) {
+        const Slot &slot = slots[index & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+            continue; // Still being written or already overwritten
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1)
+            continue;
+        events.push_back(event);
+    }
+    return events;
+}
+
+std::uint64_t TraceBuffer::dropped() const {
+    const std::uint64_t end = head.load(std::memory_order_relaxed);
+    return end > mask + 1 ? end - (mask + 1) : 0;
+}
+
+void TraceBuffer::clear() {
+    for (std::size_t i = 0; i <= mask; ++i)
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_release);
+}
+
+void TraceBuffer::write_chrome_trace(std::ostream &out) const {
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const TraceEvent &event : snapshot()) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        // Chrome traces use microsecond timestamps
+        out << "{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"pid\":0,\"tid\":" << event.thread
+            << ",\"ts\":";
+        write_micros(out, event.timestamp_ns);
+        switch (event.type) {
+        case TraceEventType::PHASE_BEGIN:
+            out << ",\"cat\":\"phase\",\"ph\":\"B\"}";
+            break;
+        case TraceEventType::PHASE_END:
+            out << ",\"cat\":\"phase\",\"ph\":\"E\"}";
+            break;
+        case TraceEventType::TASK_DISPATCH:
+            out << ",\"cat\":\"task\",\"ph\":\"B\",\"args\":{\"attempt\":"
+                << event.count << "}}";
+            break;
+        case TraceEventType::TASK_RESULT:
+            out << ",\"cat\":\"task\",\"ph\":\"E\",\"args\":{\"attempt\":"
+                << event.count << ",\"result\":" << event.value << "}}";
+            break;
+        case TraceEventType::PATH_SEARCH:
+            out << ",\"cat\":\"navigation\",\"ph\":\"X\",\"dur\":";
+            write_micros(out, event.duration_ns);
+            out << ",\"args\":{\"found\":" << event.value
+                << ",\"expanded\":" << event.count << "}}";
+            break;
+        }
+    }
+    out << "\n]}\n";
+}
+
+void TraceBuffer::write_binary(std::ostream &out) const {
+    const std::vector<TraceEvent> events = snapshot();
+    out.write("CHTR", 4);
+    write_le<std::uint32_t>(out, 1);
+    write_le<std::uint32_t>(out, static_cast<std::uint32_t>(events.size()));
+    for (const TraceEvent &event : events) {
+        write_le<std::uint64_t>(out, event.timestamp_ns);
+        write_le<std::uint64_t>(out, event.duration_ns);
+        write_le<std::uint8_t>(out, static_cast<std::uint8_t>(event.type));
+        write_le<std::uint32_t>(out, event.thread);
+        write_le<std::uint32_t>(out, static_cast<std::uint32_t>(event.value));
+        write_le<std::uint32_t>(out, event.count);
+        const std::size_t length = std::min<std::size_t>(
+            std::strlen(event.name), UINT16_MAX);
+        write_le<std::uint16_t>(out, static_cast<std::uint16_t>(length));
+        out.write(event.name, static_cast<std::streamsize>(length));
+    }
+}
+
+void TraceBuffer::install(TraceBuffer *buffer) {
+    installed_buffer.store(buffer, std::memory_order_release);
+}
+
+TraceBuffer *TraceBuffer::installed() {
+    return installed_buffer.load(std::memory_order_acquire);
+}
+
+} // namespace choros
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace choros {
+
+/**
+ * @brief Kind of a recorded trace event.
+ */
+enum class TraceEventType : std::uint8_t {
+    PHASE_BEGIN,   ///< A lifecycle phase started
+    PHASE_END,     ///< A lifecycle phase finished
+    TASK_DISPATCH, ///< An attempt at running a task started
+    TASK_RESULT,   ///< An attempt finished; `value` holds the `TaskResult`
+    PATH_SEARCH    ///< A path query finished; spans `duration_ns`
+};
+
+/**
+ * @brief A single fixed-size trace record.
+ *
+ * `name` is not copied: it must point to a string that outlives the buffer
+ * (phase names are literals, task names point into the owning `Lifecycle`).
+ */
+struct TraceEvent {
+    std::uint64_t timestamp_ns = 0; ///< Steady-clock time of the event
+    std::uint64_t duration_ns = 0;  ///< Length of `PATH_SEARCH` events
+    const char *name = "";
+    TraceEventType type = TraceEventType::PHASE_BEGIN;
+    std::uint32_t thread = 0; ///< Small per-process thread index
+    std::int32_t value = 0;   ///< Task result or path-found flag
+    std::uint32_t count = 0;  ///< Attempt number or nodes expanded
+
+    static TraceEvent phase_begin(const char *phase);
+    static TraceEvent phase_end(const char *phase);
+    static TraceEvent task_dispatch(const char *task, std::uint32_t attempt);
+    static TraceEvent task_result(const char *task, int result,
+                                  std::uint32_t attempt);
+    static TraceEvent path_search(std::uint64_t start_ns, bool found,
+                                  std::size_t expanded);
+};
+
+/**
+ * @brief Returns the current steady-clock time in nanoseconds.
+ */
+std::uint64_t trace_now();
+
+/**
+ * @brief Lock-free ring buffer of trace events.
+ *
+ * `record()` is wait-free and may be called from any thread: it claims a
+ * slot with a single atomic increment and publishes it with a per-slot
+ * sequence number. When full, the oldest events are overwritten. Snapshots
+ * and exporters skip slots that are being written concurrently, so they are
+ * best taken once the run is over.
+ *
+ * The library's built-in hooks (lifecycle phases, task attempts and
+ * `find_path` queries) record into the buffer passed to `install()`, and
+ * only when compiled with `CHOROS_ENABLE_TRACING`; otherwise they expand to
+ * nothing.
+ */
+class TraceBuffer {
+  public:
+    /**
+     * @brief Creates a buffer for at least `capacity` events (rounded up to a
+     * power of two).
+     */
+    explicit TraceBuffer(std::size_t capacity = 16384);
+
+    /**
+     * @brief Appends an event, stamping it with the calling thread's index.
+     */
+    void record(TraceEvent event);
+
+    /**
+     * @brief Returns the retained events, oldest first.
+     */
+    std::vector<TraceEvent> snapshot() const;
+
+    /**
+     * @brief Returns how many events were overwritten because the buffer
+     * wrapped around.
+     */
+    std::uint64_t dropped() const;
+
+    /**
+     * @brief Discards all events. Must not race with `record()`.
+     */
+    void clear();
+
+    /**
+     * @brief Writes the events in Chrome trace JSON format, viewable in
+     * `chrome://tracing` or Perfetto.
+     */
+    void write_chrome_trace(std::ostream &out) const;
+
+    /**
+     * @brief Writes the events in a compact binary format.
+     *
+     * Layout (little endian): magic `CHTR`, `u32` version, `u32` count, then
+     * per event `u64` timestamp, `u64` duration, `u8` type, `u32` thread,
+     * `i32` value, `u32` count, `u16` name length and the name bytes.
+     */
+    void write_binary(std::ostream &out) const;
+
+    /**
+     * @brief Sets the buffer the built-in hooks record into (nullptr to
+     * stop). The buffer must outlive its installation.
+     */
+    static void install(TraceBuffer *buffer);
+
+    /**
+     * @brief Returns the buffer the built-in hooks record into, if any.
+     */
+    static TraceBuffer *installed();
+
+  private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0}; ///< Claim index + 1 once set
+        TraceEvent event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+    std::atomic<std::uint64_t> head{0};
+};
+
+} // namespace choros
+
+#ifdef CHOROS_ENABLE_TRACING
+/// Captures a start timestamp into a new local named `var`.
+#define CHOROS_TRACE_TIMESTAMP(var)                                            \
+    const std::uint64_t var = ::choros::trace_now()
+/// Records `event` into the installed trace buffer, if any.
+#define CHOROS_TRACE_EVENT(event)                                              \
+    do {                                                                       \
+        if (auto *choros_trace_ = ::choros::TraceBuffer::installed())          \
+            choros_trace_->record(event);                                      \
+    } while (0)
+#else
+#define CHOROS_TRACE_TIMESTAMP(var) static_assert(true, "")
+#define CHOROS_TRACE_EVENT(event) ((void)0)
+#endif